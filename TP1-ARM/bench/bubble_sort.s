@@ -0,0 +1,37 @@
+.text
+// Bubble sort de 1024 enteros de 64 bits en orden inverso (peor caso)
+movz X9, 0x1000
+lsl X9, X9, 16          // X9 = arreglo
+movz X10, 1024          // X10 = n
+
+// a[i] = n - i
+movz X1, 0
+fill:
+subs X2, X10, X1
+lsl X3, X1, 3
+add X3, X9, X3
+stur X2, [X3, 0x0]
+adds X1, X1, 1
+cmp X1, X10
+blt fill
+
+subs X4, X10, 1         // X4 = i
+outer:
+movz X5, 0              // X5 = j
+add X6, X9, 0           // X6 = &a[j]
+inner:
+ldur X7, [X6, 0x0]
+ldur X8, [X6, 0x8]
+cmp X7, X8
+ble noswap
+stur X8, [X6, 0x0]
+stur X7, [X6, 0x8]
+noswap:
+add X6, X6, 8
+adds X5, X5, 1
+cmp X5, X4
+blt inner
+subs X4, X4, 1
+bgt outer
+
+HLT 0
@@ -0,0 +1,27 @@
+d2820009
+d370bd29
+d280800a
+d2800001
+eb010142
+d37df023
+8b030123
+f8000062
+b1000421
+eb0a003f
+54ffff4b
+f1000544
+d2800005
+91000126
+f84000c7
+f84080c8
+eb0800ff
+5400006d
+f80000c8
+f80080c7
+910020c6
+b10004a5
+eb0400bf
+54fffeeb
+f1000484
+54fffe6c
+d4400000
\ No newline at end of file
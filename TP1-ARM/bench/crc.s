@@ -0,0 +1,78 @@
+.text
+// CRC-32 bit a bit (EOR/LSL/LSR) sobre 16 KiB de datos, 10 pasadas
+movz X9, 0x1000
+lsl X9, X9, 16          // X9 = datos
+movz X10, 0x4000        // X10 = 16 KiB
+movz X21, 0xEDB8
+lsl X21, X21, 16
+movz X22, 0x8320
+orr X21, X21, X22       // X21 = polinomio 0xEDB88320
+movz X23, 1             // X23 = mascara del bit 0
+
+// datos[i] = (i * 7) & 0xff
+movz X1, 0
+movz X24, 7
+fill:
+mul X2, X1, X24
+add X3, X9, X1
+sturb W2, [X3, 0x0]
+adds X1, X1, 1
+cmp X1, X10
+blt fill
+
+movz X20, 10
+rep:
+movz X0, 0xFFFF         // X0 = crc
+movz X1, 0
+byte:
+add X2, X9, X1
+ldurb W3, [X2, 0x0]
+eor X0, X0, X3
+// 8 pasos: crc = (crc >> 1) ^ (poly & -(crc & 1))
+ands X4, X0, X23
+subs X4, XZR, X4
+ands X4, X21, X4
+lsr X0, X0, 1
+eor X0, X0, X4
+ands X4, X0, X23
+subs X4, XZR, X4
+ands X4, X21, X4
+lsr X0, X0, 1
+eor X0, X0, X4
+ands X4, X0, X23
+subs X4, XZR, X4
+ands X4, X21, X4
+lsr X0, X0, 1
+eor X0, X0, X4
+ands X4, X0, X23
+subs X4, XZR, X4
+ands X4, X21, X4
+lsr X0, X0, 1
+eor X0, X0, X4
+ands X4, X0, X23
+subs X4, XZR, X4
+ands X4, X21, X4
+lsr X0, X0, 1
+eor X0, X0, X4
+ands X4, X0, X23
+subs X4, XZR, X4
+ands X4, X21, X4
+lsr X0, X0, 1
+eor X0, X0, X4
+ands X4, X0, X23
+subs X4, XZR, X4
+ands X4, X21, X4
+lsr X0, X0, 1
+eor X0, X0, X4
+ands X4, X0, X23
+subs X4, XZR, X4
+ands X4, X21, X4
+lsr X0, X0, 1
+eor X0, X0, X4
+adds X1, X1, 1
+cmp X1, X10
+blt byte
+subs X20, X20, 1
+bne rep
+
+HLT 0
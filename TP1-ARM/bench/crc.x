@@ -0,0 +1,68 @@
+d2820009
+d370bd29
+d288000a
+d29db715
+d370beb5
+d2906416
+aa1602b5
+d2800037
+d2800001
+d28000f8
+9b187c22
+8b010123
+38000062
+b1000421
+eb0a003f
+54ffff6b
+d2800154
+d29fffe0
+d2800001
+8b010122
+38400043
+ca030000
+ea170004
+eb0403e4
+ea0402a4
+d341fc00
+ca040000
+ea170004
+eb0403e4
+ea0402a4
+d341fc00
+ca040000
+ea170004
+eb0403e4
+ea0402a4
+d341fc00
+ca040000
+ea170004
+eb0403e4
+ea0402a4
+d341fc00
+ca040000
+ea170004
+eb0403e4
+ea0402a4
+d341fc00
+ca040000
+ea170004
+eb0403e4
+ea0402a4
+d341fc00
+ca040000
+ea170004
+eb0403e4
+ea0402a4
+d341fc00
+ca040000
+ea170004
+eb0403e4
+ea0402a4
+d341fc00
+ca040000
+b1000421
+eb0a003f
+54fffa6b
+f1000694
+54fff9e1
+d4400000
\ No newline at end of file
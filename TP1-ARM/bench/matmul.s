@@ -0,0 +1,64 @@
+.text
+// C = A * B con matrices de 64x64 enteros de 64 bits, 3 repeticiones
+movz X9, 0x1000
+lsl X9, X9, 16          // X9 = A
+movz X10, 64            // X10 = N
+movz X11, 0x8000
+add X11, X9, X11        // X11 = B
+movz X12, 1
+lsl X12, X12, 16
+add X12, X9, X12        // X12 = C
+mul X13, X10, X10       // X13 = N*N
+
+// A[k] = k, B[k] = k ^ N
+movz X1, 0
+init:
+lsl X2, X1, 3
+add X3, X9, X2
+stur X1, [X3, 0x0]
+eor X4, X1, X10
+add X3, X11, X2
+stur X4, [X3, 0x0]
+adds X1, X1, 1
+cmp X1, X13
+blt init
+
+lsl X7, X10, 3          // X7 = bytes por fila
+movz X20, 3
+rep:
+movz X1, 0              // X1 = i
+loop_i:
+movz X2, 0              // X2 = j
+loop_j:
+movz X3, 0              // X3 = k
+movz X4, 0              // X4 = acumulador
+mul X5, X1, X10
+lsl X5, X5, 3
+add X5, X9, X5          // X5 = &A[i][0]
+lsl X6, X2, 3
+add X6, X11, X6         // X6 = &B[0][j]
+loop_k:
+ldur X14, [X5, 0x0]
+ldur X15, [X6, 0x0]
+mul X16, X14, X15
+add X4, X4, X16
+add X5, X5, 8
+add X6, X6, X7
+adds X3, X3, 1
+cmp X3, X10
+blt loop_k
+mul X17, X1, X10
+add X17, X17, X2
+lsl X17, X17, 3
+add X17, X12, X17
+stur X4, [X17, 0x0]     // C[i][j]
+adds X2, X2, 1
+cmp X2, X10
+blt loop_j
+adds X1, X1, 1
+cmp X1, X10
+blt loop_i
+subs X20, X20, 1
+bne rep
+
+HLT 0
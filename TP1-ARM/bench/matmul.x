@@ -0,0 +1,53 @@
+d2820009
+d370bd29
+d280080a
+d290000b
+8b0b012b
+d280002c
+d370bd8c
+8b0c012c
+9b0a7d4d
+d2800001
+d37df022
+8b020123
+f8000061
+ca0a0024
+8b020163
+f8000064
+b1000421
+eb0d003f
+54ffff0b
+d37df147
+d2800074
+d2800001
+d2800002
+d2800003
+d2800004
+9b0a7c25
+d37df0a5
+8b050125
+d37df046
+8b060166
+f84000ae
+f84000cf
+9b0f7dd0
+8b100084
+910020a5
+8b0700c6
+b1000463
+eb0a007f
+54ffff0b
+9b0a7c31
+8b020231
+d37df231
+8b110191
+f8000224
+b1000442
+eb0a005f
+54fffd2b
+b1000421
+eb0a003f
+54fffcab
+f1000694
+54fffc41
+d4400000
\ No newline at end of file
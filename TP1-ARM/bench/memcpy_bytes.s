@@ -0,0 +1,32 @@
+.text
+// Copia byte a byte un buffer de 64 KiB (LDURB/STURB), 40 veces
+movz X9, 0x1000
+lsl X9, X9, 16          // X9 = origen (MEM_DATA_START)
+movz X10, 1
+lsl X10, X10, 16        // X10 = 64 KiB
+add X11, X9, X10        // X11 = destino
+
+// Llenar el origen con i & 0xff
+movz X1, 0
+fill:
+add X2, X9, X1
+sturb W1, [X2, 0x0]
+adds X1, X1, 1
+cmp X1, X10
+blt fill
+
+movz X20, 40
+rep:
+movz X1, 0
+copy:
+add X2, X9, X1
+ldurb W3, [X2, 0x0]
+add X4, X11, X1
+sturb W3, [X4, 0x0]
+adds X1, X1, 1
+cmp X1, X10
+blt copy
+subs X20, X20, 1
+bne rep
+
+HLT 0
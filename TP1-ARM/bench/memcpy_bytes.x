@@ -0,0 +1,23 @@
+d2820009
+d370bd29
+d280002a
+d370bd4a
+8b0a012b
+d2800001
+8b010122
+38000041
+b1000421
+eb0a003f
+54ffff8b
+d2800514
+d2800001
+8b010122
+38400043
+8b010164
+38000083
+b1000421
+eb0a003f
+54ffff4b
+f1000694
+54fffee1
+d4400000
\ No newline at end of file
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+
+import os
+import re
+import sys
+import json
+import time
+import argparse
+import subprocess
+
+BENCHDIR = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_SIM = os.path.join(BENCHDIR, '..', 'src', 'sim')
+
+
+def parse_perfstat(out):
+    """Host counters per guest instruction printed by 'perfstat on' + go."""
+    return {m.group(1): float(m.group(2))
+            for m in re.finditer(r"^(\S+)\s+\d+\s+([\d.]+)/guest instr$", out, re.MULTILINE)}
+
+
+def run_one(sim, prog, perfstat=False):
+    """Runs prog until HLT and returns (instructions, seconds, peak RSS in KiB, host counters)."""
+    start = time.perf_counter()
+    p = subprocess.Popen([sim, prog], stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                         stderr=subprocess.DEVNULL, text=True)
+    p.stdin.write(("perfstat on\n" if perfstat else "") + "go\nrdump\nquit\n")
+    p.stdin.close()
+    out = p.stdout.read()
+    _, status, usage = os.wait4(p.pid, 0)
+    elapsed = time.perf_counter() - start
+    p.returncode = os.waitstatus_to_exitcode(status)
+
+    m = re.search(r"Instruction Count : (\d+)", out)
+    if p.returncode != 0 or not m:
+        raise RuntimeError(f"{prog}: simulator exited with {p.returncode}")
+    return int(m.group(1)), elapsed, usage.ru_maxrss, parse_perfstat(out)
+
+
+def run_micro(sim, prog, iterations=2000000):
+    """Returns the decode and memory-op ns measured by the ubench command."""
+    out = subprocess.run([sim, prog], input=f"ubench {iterations}\nquit\n", capture_output=True,
+                         text=True, check=True).stdout
+    decode = re.search(r"Decode\s*: ([\d.]+)", out)
+    mem = re.search(r"Memory op\s*: ([\d.]+)", out)
+    if not decode or not mem:
+        raise RuntimeError("simulator did not report ubench results")
+    return {"decode_ns": float(decode.group(1)), "mem_ns": float(mem.group(1))}
+
+
+def run_all(sim, programs, repeat=1, verbose=True, perfstat=False):
+    """Runs every program keeping the fastest of `repeat` runs."""
+    results = []
+    if verbose:
+        print(f"{'benchmark':<20} {'instructions':>14} {'seconds':>9} {'MIPS':>8} {'ns/instr':>9} {'RSS KiB':>9}")
+    for prog in programs:
+        runs = [run_one(sim, prog, perfstat) for _ in range(repeat)]
+        instrs, secs, rss, counters = min(runs, key=lambda r: r[1])
+        r = {
+            "benchmark": os.path.splitext(os.path.basename(prog))[0],
+            "instructions": instrs,
+            "seconds": round(secs, 6),
+            "guest_mips": round(instrs / secs / 1e6, 3),
+            "host_ns_per_instr": round(secs * 1e9 / instrs, 3),
+            "peak_rss_kib": max(run[2] for run in runs),
+        }
+        if perfstat:
+            r["host_per_guest_instr"] = counters
+        results.append(r)
+        if verbose:
+            print(f"{r['benchmark']:<20} {instrs:>14} {secs:>9.3f} {r['guest_mips']:>8.2f} "
+                  f"{r['host_ns_per_instr']:>9.2f} {r['peak_rss_kib']:>9}")
+    micro = min((run_micro(sim, programs[0]) for _ in range(repeat)), key=lambda m: m["decode_ns"])
+    if verbose:
+        print(f"decode {micro['decode_ns']:.2f} ns/instr, memory op {micro['mem_ns']:.2f} ns/access")
+    return {"sim": os.path.abspath(sim), "results": results, "micro": micro}
+
+
+def default_programs():
+    return sorted(os.path.join(BENCHDIR, f) for f in os.listdir(BENCHDIR) if f.endswith(".x"))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Run the guest benchmark corpus and report simulator speed")
+    parser.add_argument("programs", metavar="prog.x", nargs="*", help="Benchmarks to run (default: every bench/*.x)")
+    parser.add_argument("--sim", default=DEFAULT_SIM, help="Simulator binary")
+    parser.add_argument("--out", default=os.path.join(BENCHDIR, 'results.json'), help="JSON output file")
+    parser.add_argument("--repeat", type=int, default=1, help="Runs per benchmark, the fastest one is kept")
+    parser.add_argument("--perfstat", action="store_true", help="Record host HW counters per guest instruction")
+    args = parser.parse_args()
+
+    try:
+        report = run_all(args.sim, args.programs or default_programs(), args.repeat, perfstat=args.perfstat)
+    except (RuntimeError, subprocess.CalledProcessError) as e:
+        print(f"Error: {e}")
+        sys.exit(1)
+
+    with open(args.out, "w", encoding="utf-8") as f:
+        json.dump(report, f, indent=2)
+    print(f"Results written to {args.out}")
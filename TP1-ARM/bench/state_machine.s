@@ -0,0 +1,72 @@
+.text
+// Maquina de estados con entradas pseudoaleatorias (LCG), 500000 pasos
+movz X0, 0x1234         // X0 = semilla
+movz X21, 0x41C6
+lsl X21, X21, 16
+movz X22, 0x4E6D
+orr X21, X21, X22       // X21 = 1103515245
+movz X22, 12345         // X22 = incremento
+movz X23, 3             // X23 = mascara de la entrada
+movz X1, 0              // X1 = estado
+movz X10, 0x7A12
+lsl X10, X10, 4         // X10 = 500000 pasos
+movz X11, 0             // X11..X14 = visitas por estado
+movz X12, 0
+movz X13, 0
+movz X14, 0
+
+step:
+mul X0, X0, X21
+add X0, X0, X22
+lsr X2, X0, 16
+ands X2, X2, X23        // X2 = entrada (0..3)
+cmp X1, 0
+beq s0
+cmp X1, 1
+beq s1
+cmp X1, 2
+beq s2
+b s3
+
+s0:
+adds X11, X11, 1
+cbz X2, go1
+cmp X2, 1
+beq go2
+b next
+s1:
+adds X12, X12, 1
+cmp X2, 2
+bge go3
+cbnz X2, go0
+b next
+s2:
+adds X13, X13, 1
+cmp X2, 3
+beq go0
+cmp X2, 1
+ble go1
+b go3
+s3:
+adds X14, X14, 1
+cbz X2, go2
+cmp X2, 2
+blt next
+b go0
+
+go0:
+movz X1, 0
+b next
+go1:
+movz X1, 1
+b next
+go2:
+movz X1, 2
+b next
+go3:
+movz X1, 3
+next:
+subs X10, X10, 1
+bne step
+
+HLT 0
@@ -0,0 +1,56 @@
+d2824680
+d28838d5
+d370beb5
+d289cdb6
+aa1602b5
+d2860736
+d2800077
+d2800001
+d28f424a
+d37ced4a
+d280000b
+d280000c
+d280000d
+d280000e
+9b157c00
+8b160000
+d350fc02
+ea170042
+f100003f
+540000c0
+f100043f
+54000120
+f100083f
+54000180
+14000011
+b100056b
+b40002c2
+f100045f
+540002c0
+14000018
+b100058c
+f100085f
+5400028a
+b50001a2
+14000013
+b10005ad
+f1000c5f
+54000120
+f100045f
+5400012d
+1400000c
+b10005ce
+b4000102
+f100085f
+5400012b
+14000001
+d2800001
+14000006
+d2800021
+14000004
+d2800041
+14000002
+d2800061
+f100054a
+54fffb01
+d4400000
\ No newline at end of file
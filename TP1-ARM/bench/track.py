@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+
+import os
+import sys
+import csv
+import json
+import argparse
+import statistics
+import subprocess
+from datetime import datetime, timezone
+
+import run_bench
+
+parser = argparse.ArgumentParser(description="Record benchmark results per commit and fail on regressions")
+parser.add_argument("--sim", default=run_bench.DEFAULT_SIM, help="Simulator binary")
+parser.add_argument("--results", help="Use an existing results.json instead of running the benchmarks")
+parser.add_argument("--history", default=os.path.join(run_bench.BENCHDIR, 'history.csv'), help="History CSV file")
+parser.add_argument("--threshold", type=float, default=5.0, help="Allowed slowdown in percent")
+parser.add_argument("--window", type=int, default=5, help="Previous commits in the rolling baseline")
+parser.add_argument("--sigma", type=float, default=3.0, help="Noise margin in standard deviations of the baseline")
+parser.add_argument("--repeat", type=int, default=3, help="Runs per benchmark, the fastest one is kept")
+parser.add_argument("--no-record", action="store_true", help="Compare only, don't append to the history")
+args = parser.parse_args()
+
+FIELDS = ["commit", "date", "metric", "value"]
+
+
+def git_commit():
+    try:
+        rev = subprocess.run(["git", "rev-parse", "--short", "HEAD"], capture_output=True, text=True,
+                             check=True, cwd=run_bench.BENCHDIR).stdout.strip()
+        dirty = subprocess.run(["git", "status", "--porcelain", "--untracked-files=no"], capture_output=True,
+                               text=True, cwd=run_bench.BENCHDIR).stdout.strip()
+        return rev + ("-dirty" if dirty else "")
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def metrics_of(report):
+    """Flattens a results report into {metric: (value, higher_is_better)}."""
+    m = {f"{r['benchmark']}.mips": (r["guest_mips"], True) for r in report["results"]}
+    m["decode_ns"] = (report["micro"]["decode_ns"], False)
+    m["mem_ns"] = (report["micro"]["mem_ns"], False)
+    return m
+
+
+def load_history(path):
+    if not os.path.exists(path):
+        return []
+    with open(path, newline="", encoding="utf-8") as f:
+        return list(csv.DictReader(f))
+
+
+def baseline(history, metric, commit):
+    """Values of the last `window` commits (other than this one) for metric."""
+    per_commit = {}
+    for row in history:
+        if row["metric"] == metric and row["commit"] != commit:
+            per_commit.setdefault(row["commit"], []).append(float(row["value"]))
+    commits = list(per_commit)[-args.window:]
+    return [statistics.median(per_commit[c]) for c in commits]
+
+
+if args.results:
+    with open(args.results, encoding="utf-8") as f:
+        report = json.load(f)
+else:
+    report = run_bench.run_all(args.sim, run_bench.default_programs(), args.repeat)
+
+commit = git_commit()
+history = load_history(args.history)
+current = metrics_of(report)
+
+regressions = 0
+print(f"\n{'metric':<24} {'current':>10} {'baseline':>10} {'change':>8} {'limit':>7}")
+for metric, (value, higher_is_better) in current.items():
+    base = baseline(history, metric, commit)
+    if not base:
+        print(f"{metric:<24} {value:>10.3f} {'-':>10} {'-':>8} {'-':>7}  (no baseline)")
+        continue
+    ref = statistics.median(base)
+    noise = 100.0 * args.sigma * statistics.stdev(base) / ref if len(base) > 1 else 0.0
+    limit = max(args.threshold, noise)
+    change = 100.0 * (value - ref) / ref
+    slowdown = -change if higher_is_better else change
+    status = "REGRESSION" if slowdown > limit else "ok"
+    regressions += slowdown > limit
+    print(f"{metric:<24} {value:>10.3f} {ref:>10.3f} {change:>+7.2f}% {limit:>6.2f}%  {status}")
+
+if not args.no_record:
+    new_file = not os.path.exists(args.history)
+    date = datetime.now(timezone.utc).strftime("%Y-%m-%dT%H:%M:%SZ")
+    with open(args.history, "a", newline="", encoding="utf-8") as f:
+        w = csv.DictWriter(f, fieldnames=FIELDS)
+        if new_file:
+            w.writeheader()
+        for metric, (value, _) in current.items():
+            w.writerow({"commit": commit, "date": date, "metric": metric, "value": value})
+    print(f"\nRecorded {len(current)} metrics for {commit} in {args.history}")
+
+if regressions:
+    print(f"\n{regressions} metric(s) regressed more than the allowed threshold")
+    sys.exit(1)
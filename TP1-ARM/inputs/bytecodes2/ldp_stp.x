@@ -0,0 +1,19 @@
+d2820001
+d370bc21
+d2822222
+d2844443
+a9000c22
+a9010823
+a9401424
+a9411c26
+9100c029
+a9bf0d22
+a8c12d2a
+a8be7d24
+a9c2352c
+9104003f
+a9bf0fe2
+a8c13fee
+a9bf0be3
+f84083f0
+d4400000
\ No newline at end of file
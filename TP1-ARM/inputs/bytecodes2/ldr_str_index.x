@@ -0,0 +1,14 @@
+d2820001
+d370bc21
+d2824682
+d2801563
+f8008422
+f8008c23
+38001c23
+781f7c22
+f8408424
+f85f8c25
+38408c26
+785f8427
+f85f8028
+d4400000
\ No newline at end of file
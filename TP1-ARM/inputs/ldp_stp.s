@@ -0,0 +1,31 @@
+.text
+// Base en el inicio de la region de datos
+mov X1, 0x1000
+lsl X1, X1, 16
+mov X2, 0x1111
+mov X3, 0x2222
+
+// Offset con signo escalado por 8
+stp X2, X3, [X1]
+stp X3, X2, [X1, 16]
+ldp X4, X5, [X1]
+ldp X6, X7, [X1, 16]
+
+// Pre y post-indexado, con offsets negativos y XZR
+add X9, X1, 48
+stp X2, X3, [X9, -16]!
+ldp X10, X11, [X9], 16
+stp X4, XZR, [X9], -32
+ldp X12, X13, [X9, 32]!
+
+// Push/pop sobre SP
+add SP, X1, 0x100
+stp X2, X3, [SP, -16]!
+ldp X14, X15, [SP], 16
+// Push que deja SP movido
+stp X3, X2, [SP, -16]!
+ldur X16, [SP, 8]
+
+// Resultado esperado: X4 = X7 = X10 = X12 = X14 = X16 = 0x1111,
+// X5 = X6 = X11 = X15 = 0x2222, X13 = 0, X9 = 0x10000030, SP = 0x100000f0
+HLT 0
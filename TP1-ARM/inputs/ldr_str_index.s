@@ -0,0 +1,22 @@
+.text
+// Base en el inicio de la region de datos
+mov X1, 0x1000
+lsl X1, X1, 16
+mov X2, 0x1234
+mov X3, 0xAB
+
+// Post-indexado: escribe en [X1] y despues X1 += 8
+str X2, [X1], 8
+// Pre-indexado: X1 += 8 y despues escribe en [X1]
+str X3, [X1, 8]!
+strb W3, [X1, 1]!
+strh W2, [X1, -9]!
+
+// Resultado esperado: X4 = X5 = X8 = 0x1234, X6 = 0xAB, X7 = 0xABAB,
+// X1 = 0x10000008
+ldr X4, [X1], 8
+ldr X5, [X1, -8]!
+ldrb W6, [X1, 8]!
+ldrh W7, [X1], -8
+ldur X8, [X1, -8]
+HLT 0
@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "bpred.h"
+#include "shell.h"
+
+#define PC_SLOTS (MEM_TEXT_SIZE / 4)
+
+#define BIMODAL_BITS 12
+#define GSHARE_BITS 12
+#define BTB_BITS 9
+#define TAGE_TABLES 4
+#define TAGE_BITS 10
+#define TAGE_TAG_BITS 8
+#define TAGE_RESET_PERIOD (256 * 1024)
+
+typedef struct {
+    uint8_t valid;              // 0 hasta la primera asignacion
+    uint8_t tag;
+    int8_t ctr;                 // -4..3, predice taken si >= 0
+    uint8_t u;                  // 0..3
+} TageEntry;
+
+typedef struct {
+    uint64_t tag, target;
+} BTBEntry;
+
+typedef struct {
+    uint64_t execs, taken, miss[BP_NPREDICTORS];
+} BranchPC;
+
+static const char *predictor_names[BP_NPREDICTORS] = { "bimodal", "gshare", "TAGE" };
+static const int tage_hist[TAGE_TABLES] = { 4, 8, 16, 32 };
+
+int bpred_enabled = 0;
+
+static uint8_t bimodal[1 << BIMODAL_BITS];
+static uint8_t gshare[1 << GSHARE_BITS];
+static uint8_t tage_base[1 << BIMODAL_BITS];
+static TageEntry tage[TAGE_TABLES][1 << TAGE_BITS];
+static BTBEntry btb[1 << BTB_BITS];
+static uint64_t ghr = 0;
+static uint64_t tage_updates = 0;
+
+static BranchPC *per_pc = NULL;
+static uint64_t cond_branches = 0, mispredicts[BP_NPREDICTORS];
+static uint64_t indirect_branches = 0, btb_misses = 0, cond_btb_misses = 0;
+static uint64_t start_count = 0;
+static uint32_t penalty = 15;
+
+static int ctr2_predict(uint8_t c) { return c >= 2; }
+
+static void ctr2_update(uint8_t *c, int taken) {
+    if (taken && *c < 3) (*c)++;
+    if (!taken && *c > 0) (*c)--;
+}
+
+// Pliega los ultimos len bits del historial en bits bits
+static uint32_t fold(uint64_t hist, int len, int bits) {
+    uint64_t h = hist & ((1ull << len) - 1);
+    uint32_t r = 0;
+    for (; h; h >>= bits) r ^= h & ((1u << bits) - 1);
+    return r;
+}
+
+static uint32_t tage_index(uint64_t pc, int t) {
+    return ((pc >> 2) ^ (pc >> (2 + TAGE_BITS)) ^ fold(ghr, tage_hist[t], TAGE_BITS)) & ((1 << TAGE_BITS) - 1);
+}
+
+static uint8_t tage_tag(uint64_t pc, int t) {
+    return ((pc >> 2) ^ fold(ghr, tage_hist[t], TAGE_TAG_BITS) ^ (fold(ghr, tage_hist[t], TAGE_TAG_BITS - 1) << 1));
+}
+
+static int tage_predict_update(uint64_t pc, int taken) {
+    uint32_t idx[TAGE_TABLES];
+    uint8_t tag[TAGE_TABLES];
+    int provider = -1, alt = -1;
+    uint8_t *base = &tage_base[(pc >> 2) & ((1 << BIMODAL_BITS) - 1)];
+
+    for (int t = TAGE_TABLES - 1; t >= 0; t--) {
+        idx[t] = tage_index(pc, t);
+        tag[t] = tage_tag(pc, t);
+        if (tage[t][idx[t]].valid && tage[t][idx[t]].tag == tag[t]) {
+            if (provider < 0) provider = t;
+            else if (alt < 0) alt = t;
+        }
+    }
+    int alt_pred = alt >= 0 ? tage[alt][idx[alt]].ctr >= 0 : ctr2_predict(*base);
+    int pred = provider >= 0 ? tage[provider][idx[provider]].ctr >= 0 : alt_pred;
+
+    if (provider >= 0) {
+        TageEntry *e = &tage[provider][idx[provider]];
+        if (pred != alt_pred) {
+            if (pred == taken && e->u < 3) e->u++;
+            if (pred != taken && e->u > 0) e->u--;
+        }
+        if (taken && e->ctr < 3) e->ctr++;
+        if (!taken && e->ctr > -4) e->ctr--;
+    } else {
+        ctr2_update(base, taken);
+    }
+
+    // Mispredict: se asigna una entrada en una tabla de historial mas largo
+    if (pred != taken && provider < TAGE_TABLES - 1) {
+        int allocated = 0;
+        for (int t = provider + 1; t < TAGE_TABLES && !allocated; t++) {
+            TageEntry *e = &tage[t][idx[t]];
+            if (e->u == 0) {
+                e->valid = 1;
+                e->tag = tag[t];
+                e->ctr = taken ? 0 : -1;
+                allocated = 1;
+            }
+        }
+        if (!allocated)
+            for (int t = provider + 1; t < TAGE_TABLES; t++)
+                if (tage[t][idx[t]].u > 0) tage[t][idx[t]].u--;
+    }
+
+    if (++tage_updates % TAGE_RESET_PERIOD == 0)
+        for (int t = 0; t < TAGE_TABLES; t++)
+            for (int i = 0; i < (1 << TAGE_BITS); i++) tage[t][i].u >>= 1;
+    return pred;
+}
+
+// Devuelve 1 si el BTB tenia el destino correcto y lo actualiza
+static int btb_lookup_update(uint64_t pc, uint64_t target) {
+    BTBEntry *e = &btb[(pc >> 2) & ((1 << BTB_BITS) - 1)];
+    int hit = e->tag == pc && e->target == target;
+    e->tag = pc;
+    e->target = target;
+    return hit;
+}
+
+void bpred_enable(void) {
+    if (!per_pc) {
+        per_pc = calloc(PC_SLOTS, sizeof(BranchPC));
+        bpred_reset();
+    }
+    bpred_enabled = 1;
+}
+
+void bpred_disable(void) {
+    bpred_enabled = 0;
+}
+
+void bpred_reset(void) {
+    memset(bimodal, 1, sizeof(bimodal));
+    memset(gshare, 1, sizeof(gshare));
+    memset(tage_base, 1, sizeof(tage_base));
+    memset(tage, 0, sizeof(tage));
+    memset(btb, 0, sizeof(btb));
+    memset(mispredicts, 0, sizeof(mispredicts));
+    if (per_pc) memset(per_pc, 0, PC_SLOTS * sizeof(BranchPC));
+    ghr = tage_updates = 0;
+    cond_branches = indirect_branches = btb_misses = cond_btb_misses = 0;
+    start_count = INSTRUCTION_COUNT;
+}
+
+void bpred_set_penalty(uint32_t cycles) {
+    penalty = cycles;
+}
+
+void bpred_conditional(uint64_t pc, int taken, uint64_t target) {
+    int pred[BP_NPREDICTORS];
+    uint8_t *b = &bimodal[(pc >> 2) & ((1 << BIMODAL_BITS) - 1)];
+    uint8_t *g = &gshare[((pc >> 2) ^ ghr) & ((1 << GSHARE_BITS) - 1)];
+
+    pred[BP_BIMODAL] = ctr2_predict(*b);
+    pred[BP_GSHARE] = ctr2_predict(*g);
+    pred[BP_TAGE] = tage_predict_update(pc, taken);
+    ctr2_update(b, taken);
+    ctr2_update(g, taken);
+    ghr = (ghr << 1) | taken;
+    if (taken && !btb_lookup_update(pc, target)) cond_btb_misses++;
+
+    cond_branches++;
+    uint64_t i = (pc - MEM_TEXT_START) >> 2;
+    BranchPC *p = i < PC_SLOTS ? &per_pc[i] : NULL;
+    if (p) {
+        p->execs++;
+        p->taken += taken;
+    }
+    for (int k = 0; k < BP_NPREDICTORS; k++) {
+        int miss = pred[k] != taken;
+        mispredicts[k] += miss;
+        if (p) p->miss[k] += miss;
+    }
+}
+
+void bpred_indirect(uint64_t pc, uint64_t target) {
+    int hit = btb_lookup_update(pc, target);
+    uint64_t i = (pc - MEM_TEXT_START) >> 2;
+    indirect_branches++;
+    btb_misses += !hit;
+    if (i < PC_SLOTS) {
+        per_pc[i].execs++;
+        per_pc[i].taken++;
+        for (int k = 0; k < BP_NPREDICTORS; k++) per_pc[i].miss[k] += !hit;
+    }
+}
+
+static uint32_t sort_predictor = BP_TAGE;
+
+static int by_miss_desc(const void *a, const void *b) {
+    uint64_t ma = per_pc[*(const uint32_t *)a].miss[sort_predictor];
+    uint64_t mb = per_pc[*(const uint32_t *)b].miss[sort_predictor];
+    return (ma < mb) - (ma > mb);
+}
+
+void bpred_report(FILE *out, int top) {
+    uint64_t instrs = INSTRUCTION_COUNT - start_count;
+    uint32_t *idx, n = 0;
+
+    if (!per_pc) {
+        fprintf(out, "Branch prediction disabled, use 'bpred on'\n\n");
+        return;
+    }
+    fprintf(out, "\nBranch prediction (%" PRIu64 " conditional, %" PRIu64 " indirect, %" PRIu64
+            " instructions, %u cycle penalty):\n", cond_branches, indirect_branches, instrs, penalty);
+    fprintf(out, "-------------------------------------\n");
+    for (int k = 0; k < BP_NPREDICTORS; k++) {
+        uint64_t miss = mispredicts[k] + btb_misses;
+        fprintf(out, "%-8s mispredicts %10" PRIu64 "  rate %6.2f%%  MPKI %7.2f  CPI penalty %.3f\n",
+                predictor_names[k], miss, cond_branches + indirect_branches ?
+                100.0 * miss / (cond_branches + indirect_branches) : 0.0,
+                instrs ? 1000.0 * miss / instrs : 0.0, instrs ? (double)miss * penalty / instrs : 0.0);
+    }
+    fprintf(out, "BTB      indirect target misses %" PRIu64 ", taken conditional misses %" PRIu64 "\n",
+            btb_misses, cond_btb_misses);
+
+    idx = malloc(PC_SLOTS * sizeof(uint32_t));
+    for (uint32_t i = 0; i < PC_SLOTS; i++)
+        if (per_pc[i].execs) idx[n++] = i;
+    qsort(idx, n, sizeof(uint32_t), by_miss_desc);
+    fprintf(out, "\nBranch PCs by TAGE mispredicts (rate bimodal / gshare / TAGE):\n");
+    for (uint32_t k = 0; k < n && k < top; k++) {
+        BranchPC *p = &per_pc[idx[k]];
+        fprintf(out, "  0x%08" PRIx64 "  execs %10" PRIu64 "  taken %6.2f%%  miss %6.2f%% / %6.2f%% / %6.2f%%\n",
+                (uint64_t)MEM_TEXT_START + 4 * idx[k], p->execs, 100.0 * p->taken / p->execs,
+                100.0 * p->miss[BP_BIMODAL] / p->execs, 100.0 * p->miss[BP_GSHARE] / p->execs,
+                100.0 * p->miss[BP_TAGE] / p->execs);
+    }
+    fprintf(out, "\n");
+    free(idx);
+}
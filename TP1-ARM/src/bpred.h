@@ -0,0 +1,21 @@
+#ifndef BPRED_H
+#define BPRED_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Modelos de prediccion de saltos (bimodal, gshare, TAGE reducido y BTB)
+// alimentados con el resultado real de cada salto del guest.
+enum { BP_BIMODAL, BP_GSHARE, BP_TAGE, BP_NPREDICTORS };
+
+extern int bpred_enabled;
+
+void bpred_enable(void);
+void bpred_disable(void);
+void bpred_reset(void);
+void bpred_set_penalty(uint32_t cycles);
+void bpred_conditional(uint64_t pc, int taken, uint64_t target);
+void bpred_indirect(uint64_t pc, uint64_t target);
+void bpred_report(FILE *out, int top);
+
+#endif
@@ -0,0 +1,256 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "cache.h"
+#include "shell.h"
+
+#define PC_SLOTS (MEM_TEXT_SIZE / 4)
+
+typedef struct {
+    const char *name;
+    uint32_t size, assoc, line, sets;
+    int line_bits, repl, write_policy;
+    uint64_t *tags;             // sets * assoc, tag = addr >> line_bits
+    uint8_t *valid, *dirty;
+    uint64_t *stamp;            // LRU: ultimo uso de cada via
+    uint64_t *plru;             // PLRU: arbol de assoc-1 bits por set
+    uint64_t clock;
+    uint64_t hits, misses, writebacks;
+} Cache;
+
+typedef struct {
+    uint64_t accesses, stalls;
+} PCStall;
+
+int cache_enabled = 0;
+
+static Cache levels[CACHE_NLEVELS] = {
+    { "L1I", 32 * 1024, 8, 64 },
+    { "L1D", 32 * 1024, 8, 64 },
+    { "L2", 256 * 1024, 8, 64 },
+};
+static uint32_t l2_latency = 12;
+static uint32_t mem_latency = 100;
+static uint64_t memory_writebacks = 0;
+static PCStall *pc_stalls = NULL;
+static uint64_t fetch_stalls = 0;
+
+static int log2_exact(uint32_t x) {
+    int b = 0;
+    if (x == 0 || (x & (x - 1))) return -1;
+    while ((1u << b) != x) b++;
+    return b;
+}
+
+static void cache_free(Cache *c) {
+    free(c->tags);
+    free(c->valid);
+    free(c->dirty);
+    free(c->stamp);
+    free(c->plru);
+    c->tags = NULL;
+}
+
+static int cache_alloc(Cache *c) {
+    uint32_t n;
+    cache_free(c);
+    c->line_bits = log2_exact(c->line);
+    if (c->line_bits < 0 || c->assoc == 0 || c->assoc > 64 || c->size % (c->line * c->assoc))
+        return -1;
+    c->sets = c->size / (c->line * c->assoc);
+    if (log2_exact(c->sets) < 0 || (c->repl == REPL_PLRU && log2_exact(c->assoc) < 0))
+        return -1;
+    n = c->sets * c->assoc;
+    c->tags = calloc(n, sizeof(uint64_t));
+    c->valid = calloc(n, 1);
+    c->dirty = calloc(n, 1);
+    c->stamp = calloc(n, sizeof(uint64_t));
+    c->plru = calloc(c->sets, sizeof(uint64_t));
+    c->clock = c->hits = c->misses = c->writebacks = 0;
+    return 0;
+}
+
+// Arbol PLRU: el nodo k tiene hijos 2k+1 y 2k+2; bit en 1 = el victima esta a la derecha
+static void plru_touch(Cache *c, uint32_t set, uint32_t way) {
+    uint32_t node = 0;
+    for (uint32_t span = c->assoc; span > 1; span >>= 1) {
+        int right = way >= span / 2;
+        if (right) c->plru[set] &= ~(1ull << node);
+        else c->plru[set] |= 1ull << node;
+        way -= right ? span / 2 : 0;
+        node = 2 * node + 1 + right;
+    }
+}
+
+static uint32_t plru_victim(Cache *c, uint32_t set) {
+    uint32_t node = 0, way = 0;
+    for (uint32_t span = c->assoc; span > 1; span >>= 1) {
+        int right = (c->plru[set] >> node) & 1;
+        way += right ? span / 2 : 0;
+        node = 2 * node + 1 + right;
+    }
+    return way;
+}
+
+static void touch(Cache *c, uint32_t set, uint32_t way) {
+    if (c->repl == REPL_PLRU) plru_touch(c, set, way);
+    else c->stamp[set * c->assoc + way] = ++c->clock;
+}
+
+static uint32_t victim(Cache *c, uint32_t set) {
+    uint32_t base = set * c->assoc, best = 0;
+    for (uint32_t w = 0; w < c->assoc; w++)
+        if (!c->valid[base + w]) return w;
+    if (c->repl == REPL_PLRU) return plru_victim(c, set);
+    for (uint32_t w = 1; w < c->assoc; w++)
+        if (c->stamp[base + w] < c->stamp[base + best]) best = w;
+    return best;
+}
+
+static uint32_t lookup(Cache *c, uint64_t addr, int is_write);
+
+// Accede a una linea en el nivel c y devuelve los ciclos de stall que agrega
+static uint32_t next_level(Cache *c, uint64_t addr, int is_write) {
+    if (c == &levels[CACHE_L2]) {
+        if (is_write) memory_writebacks++;
+        return mem_latency;
+    }
+    return l2_latency + lookup(&levels[CACHE_L2], addr, is_write);
+}
+
+static uint32_t lookup(Cache *c, uint64_t addr, int is_write) {
+    uint64_t tag = addr >> c->line_bits;
+    uint32_t set = tag & (c->sets - 1), base = set * c->assoc;
+    uint32_t stall = 0;
+
+    for (uint32_t w = 0; w < c->assoc; w++) {
+        if (c->valid[base + w] && c->tags[base + w] == tag) {
+            c->hits++;
+            touch(c, set, w);
+            if (is_write && c->write_policy == WRITE_THROUGH) return next_level(c, addr, 1);
+            c->dirty[base + w] |= is_write;
+            return 0;
+        }
+    }
+
+    c->misses++;
+    if (is_write && c->write_policy == WRITE_THROUGH)   // sin write-allocate
+        return next_level(c, addr, 1);
+
+    uint32_t w = victim(c, set);
+    if (c->valid[base + w] && c->dirty[base + w]) {
+        c->writebacks++;
+        next_level(c, c->tags[base + w] << c->line_bits, 1);
+    }
+    stall = next_level(c, addr, 0);
+    c->tags[base + w] = tag;
+    c->valid[base + w] = 1;
+    c->dirty[base + w] = is_write;
+    touch(c, set, w);
+    return stall;
+}
+
+int cache_enable(void) {
+    for (int i = 0; i < CACHE_NLEVELS; i++)
+        if (!levels[i].tags && cache_alloc(&levels[i]) != 0) return -1;
+    if (!pc_stalls) pc_stalls = calloc(PC_SLOTS, sizeof(PCStall));
+    cache_enabled = 1;
+    return 0;
+}
+
+void cache_disable(void) {
+    cache_enabled = 0;
+}
+
+int cache_configure(int level, uint32_t size, uint32_t assoc, uint32_t line, int repl, int write_policy) {
+    Cache *c = &levels[level];
+    Cache old = *c;
+    c->size = size;
+    c->assoc = assoc;
+    c->line = line;
+    c->repl = repl;
+    c->write_policy = write_policy;
+    c->tags = NULL;
+    c->valid = c->dirty = NULL;
+    c->stamp = c->plru = NULL;
+    if (cache_alloc(c) != 0) {
+        cache_free(c);
+        *c = old;
+        return -1;
+    }
+    cache_free(&old);
+    return 0;
+}
+
+void cache_set_latency(uint32_t l2_hit, uint32_t memory) {
+    l2_latency = l2_hit;
+    mem_latency = memory;
+}
+
+void cache_reset(void) {
+    for (int i = 0; i < CACHE_NLEVELS; i++)
+        if (levels[i].tags) cache_alloc(&levels[i]);
+    if (pc_stalls) memset(pc_stalls, 0, PC_SLOTS * sizeof(PCStall));
+    memory_writebacks = fetch_stalls = 0;
+}
+
+void cache_fetch(uint64_t pc) {
+    fetch_stalls += lookup(&levels[CACHE_L1I], pc, 0);
+}
+
+void cache_data_access(uint64_t addr, int size, int is_write) {
+    Cache *c = &levels[CACHE_L1D];
+    uint32_t stall = lookup(c, addr, is_write);
+    // Acceso que cruza el limite de linea: se cuenta tambien la siguiente
+    if ((addr >> c->line_bits) != ((addr + size - 1) >> c->line_bits))
+        stall += lookup(c, addr + size - 1, is_write);
+
+    uint64_t idx = (CURRENT_STATE.PC - MEM_TEXT_START) >> 2;
+    if (idx < PC_SLOTS) {
+        pc_stalls[idx].accesses++;
+        pc_stalls[idx].stalls += stall;
+    }
+}
+
+static int by_stalls_desc(const void *a, const void *b) {
+    uint64_t sa = pc_stalls[*(const uint32_t *)a].stalls, sb = pc_stalls[*(const uint32_t *)b].stalls;
+    return (sa < sb) - (sa > sb);
+}
+
+void cache_report(FILE *out, int top) {
+    uint64_t data_stalls = 0;
+    uint32_t *idx, n = 0;
+
+    if (!pc_stalls) {
+        fprintf(out, "Cache model disabled, use 'cache on'\n\n");
+        return;
+    }
+    fprintf(out, "\nCache hierarchy (L2 hit %u cycles, memory %u cycles):\n", l2_latency, mem_latency);
+    fprintf(out, "-------------------------------------\n");
+    for (int i = 0; i < CACHE_NLEVELS; i++) {
+        Cache *c = &levels[i];
+        uint64_t total = c->hits + c->misses;
+        fprintf(out, "%-4s %6uK %2u-way %3uB %-4s %s  hits %10" PRIu64 "  misses %10" PRIu64
+                "  hit rate %6.2f%%  writebacks %" PRIu64 "\n", c->name, c->size / 1024, c->assoc, c->line,
+                c->repl == REPL_PLRU ? "PLRU" : "LRU", c->write_policy == WRITE_THROUGH ? "WT" : "WB",
+                c->hits, c->misses, total ? 100.0 * c->hits / total : 0.0, c->writebacks);
+    }
+
+    idx = malloc(PC_SLOTS * sizeof(uint32_t));
+    for (uint32_t i = 0; i < PC_SLOTS; i++) {
+        data_stalls += pc_stalls[i].stalls;
+        if (pc_stalls[i].accesses) idx[n++] = i;
+    }
+    qsort(idx, n, sizeof(uint32_t), by_stalls_desc);
+    fprintf(out, "Memory writebacks : %" PRIu64 "\n", memory_writebacks);
+    fprintf(out, "Stall cycles      : %" PRIu64 " fetch, %" PRIu64 " load/store\n", fetch_stalls, data_stalls);
+    fprintf(out, "\nLoad/store PCs by stall cycles:\n");
+    for (uint32_t k = 0; k < n && k < top; k++) {
+        PCStall *p = &pc_stalls[idx[k]];
+        fprintf(out, "  0x%08" PRIx64 "  accesses %10" PRIu64 "  stalls %12" PRIu64 "  %6.2f/access\n",
+                (uint64_t)MEM_TEXT_START + 4 * idx[k], p->accesses, p->stalls, (double)p->stalls / p->accesses);
+    }
+    fprintf(out, "\n");
+    free(idx);
+}
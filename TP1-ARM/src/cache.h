@@ -0,0 +1,24 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Modelo de timing de una jerarquia L1I/L1D/L2 para los accesos del guest.
+// Solo cuenta hits/misses y ciclos de stall, no guarda datos.
+enum { CACHE_L1I, CACHE_L1D, CACHE_L2, CACHE_NLEVELS };
+enum { REPL_LRU, REPL_PLRU };
+enum { WRITE_BACK, WRITE_THROUGH };
+
+extern int cache_enabled;
+
+int cache_enable(void);
+void cache_disable(void);
+int cache_configure(int level, uint32_t size, uint32_t assoc, uint32_t line, int repl, int write_policy);
+void cache_set_latency(uint32_t l2_hit, uint32_t memory);
+void cache_reset(void);
+void cache_fetch(uint64_t pc);
+void cache_data_access(uint64_t addr, int size, int is_write);
+void cache_report(FILE *out, int top);
+
+#endif
@@ -0,0 +1,42 @@
+#include <stdio.h>
+#include <string.h>
+#include "coverage.h"
+
+int coverage_enabled = 0;
+uint8_t coverage_map[COVERAGE_SIZE];
+uint32_t coverage_prev = 0;
+char coverage_path[256] = "coverage.bin";
+
+void coverage_clear(void) {
+    memset(coverage_map, 0, sizeof(coverage_map));
+    coverage_prev = 0;
+}
+
+// Cantidad de aristas con al menos un hit
+uint32_t coverage_count(const uint8_t *map) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < COVERAGE_SIZE; i++) n += map[i] != 0;
+    return n;
+}
+
+int coverage_export(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return -1;
+    size_t n = fwrite(coverage_map, 1, COVERAGE_SIZE, f);
+    return fclose(f) == 0 && n == COVERAGE_SIZE ? 0 : -1;
+}
+
+// Suma (saturando) un mapa exportado por otra corrida al mapa actual
+int coverage_merge(const char *path) {
+    uint8_t other[COVERAGE_SIZE];
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    size_t n = fread(other, 1, COVERAGE_SIZE, f);
+    fclose(f);
+    if (n != COVERAGE_SIZE) return -1;
+    for (uint32_t i = 0; i < COVERAGE_SIZE; i++) {
+        unsigned sum = coverage_map[i] + other[i];
+        coverage_map[i] = sum > 255 ? 255 : sum;
+    }
+    return 0;
+}
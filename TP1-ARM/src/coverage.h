@@ -0,0 +1,30 @@
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include <stdint.h>
+
+// Mapa de cobertura de aristas estilo AFL: un contador de 8 bits por hash
+// de (bloque anterior, bloque actual). Lo actualizan los handlers de salto,
+// tanto si el salto se toma como si no. El contador satura en 255 para que
+// una arista recorrida un multiplo de 256 veces no vuelva a cero.
+#define COVERAGE_SIZE (1 << 16)
+
+extern int coverage_enabled;
+extern uint8_t coverage_map[COVERAGE_SIZE];
+extern uint32_t coverage_prev;
+
+static inline void coverage_edge(uint64_t pc) {
+    uint32_t cur = ((uint32_t)(pc >> 2) * 0x9E3779B1u) >> 16;
+    uint8_t *c = &coverage_map[cur ^ coverage_prev];
+    *c += *c != 255;
+    coverage_prev = cur >> 1;
+}
+
+extern char coverage_path[256];
+
+void coverage_clear(void);
+uint32_t coverage_count(const uint8_t *map);
+int coverage_export(const char *path);
+int coverage_merge(const char *path);
+
+#endif
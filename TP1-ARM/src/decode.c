@@ -3,6 +3,10 @@
 #include <inttypes.h>
 #include "decode.h"
 #include "shell.h"
+#include "cache.h"
+
+HART_LOCAL uint64_t mem_last_addr = 0;
+HART_LOCAL uint64_t mem_last_value = 0;
 
 void decode_i_group(uint32_t instr, uint32_t *imm12, uint32_t *shift, uint32_t *d, uint32_t *n) {
     *imm12 = (instr >> 10) & 0xFFF;
@@ -76,34 +80,47 @@ void update_flags(int64_t result) {
 }
 
 uint8_t mem_read_8(uint64_t addr) {
+    if (cache_enabled) cache_data_access(addr, 1, 0);
+    mem_last_addr = addr;
     uint32_t word = mem_read_32(addr & ~0x3);
-    return (word >> ((addr & 0x3) * 8)) & 0xFF;
+    mem_last_value = (word >> ((addr & 0x3) * 8)) & 0xFF;
+    return mem_last_value;
 }
 
 uint16_t mem_read_16(uint64_t addr) {
+    if (cache_enabled) cache_data_access(addr, 2, 0);
+    mem_last_addr = addr;
     uint32_t word = mem_read_32(addr & ~0x3);
-    return (word >> (((addr & 0x3) / 2) * 16)) & 0xFFFF;
+    mem_last_value = (word >> (((addr & 0x3) / 2) * 16)) & 0xFFFF;
+    return mem_last_value;
 }
 
 uint64_t mem_read_64(uint64_t addr) {
+    if (cache_enabled) cache_data_access(addr, 8, 0);
+    mem_last_addr = addr;
     uint64_t aligned_addr = addr & ~0x7;
     uint32_t offset = addr & 0x7;
     if (offset) {
         uint64_t low_part = mem_read_32(aligned_addr);
         uint64_t high_part = mem_read_32(aligned_addr + 4);
         if (offset <= 4) {
-            return (high_part << (8 * (4 - offset))) | (low_part >> (8 * offset));
+            mem_last_value = (high_part << (8 * (4 - offset))) | (low_part >> (8 * offset));
         } else {
-            return (high_part >> (8 * (offset - 4))) | (low_part << (8 * (8 - offset)));
+            mem_last_value = (high_part >> (8 * (offset - 4))) | (low_part << (8 * (8 - offset)));
         }
+        return mem_last_value;
     } else {
         uint64_t low_part = mem_read_32(addr);
         uint64_t high_part = mem_read_32(addr + 4);
-        return low_part | (high_part << 32);
+        mem_last_value = low_part | (high_part << 32);
+        return mem_last_value;
     }
 }
 
 void mem_write_8(uint64_t addr, uint8_t value) {
+    if (cache_enabled) cache_data_access(addr, 1, 1);
+    mem_last_addr = addr;
+    mem_last_value = value;
     uint64_t a = addr & ~0x3;
     uint32_t word = mem_read_32(a);
     int offset = addr & 0x3;
@@ -113,6 +130,9 @@ void mem_write_8(uint64_t addr, uint8_t value) {
 }
 
 void mem_write_16(uint64_t addr, uint16_t value) {
+    if (cache_enabled) cache_data_access(addr, 2, 1);
+    mem_last_addr = addr;
+    mem_last_value = value;
     uint64_t a = addr & ~0x3;
     uint32_t word = mem_read_32(a);
     int offset = (addr & 0x3) / 2;
@@ -122,6 +142,9 @@ void mem_write_16(uint64_t addr, uint16_t value) {
 }
 
 void mem_write_64(uint64_t addr, uint64_t value) {
+    if (cache_enabled) cache_data_access(addr, 8, 1);
+    mem_last_addr = addr;
+    mem_last_value = value;
     uint64_t aligned_addr = addr & ~0x7;
     uint32_t offset = addr & 0x7;
     if (offset) {
@@ -3,6 +3,13 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "shell.h"
+
+// Indice del registro 31 segun el contexto, sin ramas: ZR_W manda las
+// escrituras a XZR al slot de descarte y SP_R resuelve 31 como SP.
+// Las lecturas de XZR usan el indice tal cual (REGS[31] vale siempre 0).
+#define ZR_W(r) ((r) + ((((r) + 1) >> 5) << 1))
+#define SP_R(r) ((r) + (((r) + 1) >> 5))
 
 void decode_i_group(uint32_t instr, uint32_t *imm12, uint32_t *shift, uint32_t *d, uint32_t *n);
 void decode_r_group(uint32_t instr, uint32_t *opt, uint32_t *imm3, uint32_t *d, uint32_t *n, uint32_t *m);
@@ -15,6 +22,10 @@ int64_t sign_extend(int64_t value, int bits);
 int64_t calculate_mathOps(uint32_t n, uint32_t m, uint32_t opt, uint32_t imm3, int isSubtraction, int isImm);
 void update_flags(int64_t result);
 
+// Ultima direccion y valor accedidos por los helpers de memoria del guest
+extern HART_LOCAL uint64_t mem_last_addr;
+extern HART_LOCAL uint64_t mem_last_value;
+
 uint8_t mem_read_8(uint64_t addr);
 uint16_t mem_read_16(uint64_t addr);
 uint64_t mem_read_64(uint64_t addr);
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include "device.h"
+#include "shell.h"
+#include "event.h"
+#include "hart.h"
+
+#define UART_BUF_SIZE 4096
+
+int device_count = 0;
+
+// Ordenada por start para buscar con busqueda binaria
+static Device devices[DEVICE_MAX];
+
+// Inserta el dispositivo en orden; falla si se superpone con otro
+int device_register(const Device *dev) {
+    int i = 0;
+    if (device_count == DEVICE_MAX || dev->size == 0) return -1;
+    while (i < device_count && devices[i].start < dev->start) i++;
+    if (i > 0 && devices[i - 1].start + devices[i - 1].size > dev->start) return -1;
+    if (i < device_count && dev->start + dev->size > devices[i].start) return -1;
+    memmove(&devices[i + 1], &devices[i], (device_count - i) * sizeof(Device));
+    devices[i] = *dev;
+    device_count++;
+    return 0;
+}
+
+const Device *device_find(uint64_t address) {
+    int lo = 0, hi = device_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (address < devices[mid].start) hi = mid - 1;
+        else if (address - devices[mid].start >= devices[mid].size) lo = mid + 1;
+        else return &devices[mid];
+    }
+    return NULL;
+}
+
+void device_flush_all(void) {
+    for (int i = 0; i < device_count; i++)
+        if (devices[i].flush) devices[i].flush();
+}
+
+void device_list(void) {
+    printf("\nDevices:\n");
+    printf("-------------------------------------\n");
+    for (int i = 0; i < device_count; i++)
+        printf("  0x%08" PRIx64 "-0x%08" PRIx64 "  %s\n", devices[i].start,
+               devices[i].start + devices[i].size - 1, devices[i].name);
+    printf("\n");
+}
+
+/* UART */
+
+static char uart_buf[UART_BUF_SIZE];
+static size_t uart_len = 0;
+static int uart_event = -1;
+static pthread_mutex_t uart_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void uart_drain(void) {
+    fwrite(uart_buf, 1, uart_len, stdout);
+    fflush(stdout);
+    uart_len = 0;
+    event_cancel(uart_event);
+    uart_event = -1;
+}
+
+static void uart_flush(void) {
+    pthread_mutex_lock(&uart_lock);
+    if (uart_len) uart_drain();
+    pthread_mutex_unlock(&uart_lock);
+}
+
+// Una linea sin '\n' no queda en el buffer indefinidamente
+static void uart_timeout(void *arg) {
+    uart_event = -1;
+    uart_flush();
+}
+
+static uint32_t uart_read(uint64_t offset) {
+    return offset == UART_STATUS;
+}
+
+static void uart_write(uint64_t offset, uint32_t value) {
+    if (offset != UART_DATA) return;
+    pthread_mutex_lock(&uart_lock);
+    if (uart_len == 0 && uart_event < 0)
+        uart_event = event_schedule(hart_clock() + UART_FLUSH_DELAY, uart_timeout, NULL);
+    uart_buf[uart_len++] = value & 0xFF;
+    if ((value & 0xFF) == '\n' || uart_len == UART_BUF_SIZE) uart_drain();
+    pthread_mutex_unlock(&uart_lock);
+}
+
+/* Contador */
+
+static uint32_t timer_read(uint64_t offset) {
+    if (offset == TIMER_LO) return hart_clock();
+    if (offset == TIMER_HI) return hart_clock() >> 32;
+    return 0;
+}
+
+static void timer_write(uint64_t offset, uint32_t value) {
+}
+
+void devices_init(void) {
+    static const Device uart = { "uart", UART_BASE, 0x1000, uart_read, uart_write, uart_flush };
+    static const Device timer = { "timer", TIMER_BASE, 0x1000, timer_read, timer_write, NULL };
+    if (device_count) return;
+    device_register(&uart);
+    device_register(&timer);
+}
@@ -0,0 +1,42 @@
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include <stdint.h>
+
+// Dispositivos mapeados en memoria. mem_read_32/mem_write_32 consultan la
+// tabla solo cuando la direccion no cae en ninguna de las MEM_REGIONS, asi
+// los accesos normales no pagan nada. Los dispositivos ven accesos de 32
+// bits alineados con el offset dentro de su rango.
+#define DEVICE_MAX 16
+
+typedef struct {
+    const char *name;
+    uint64_t start, size;
+    uint32_t (*read)(uint64_t offset);
+    void (*write)(uint64_t offset, uint32_t value);
+    void (*flush)(void);        // opcional, al terminar la corrida
+} Device;
+
+extern int device_count;
+
+int device_register(const Device *dev);
+const Device *device_find(uint64_t address);
+void device_flush_all(void);
+void device_list(void);
+void devices_init(void);
+
+// UART: escribir DATA manda el byte bajo a un buffer del host que se vacia
+// en cada '\n', cuando se llena, al terminar (HLT) o UART_FLUSH_DELAY
+// instrucciones despues del primer byte pendiente. STATUS siempre lee 1
+// (listo para transmitir).
+#define UART_BASE   0x09000000
+#define UART_DATA   0x0
+#define UART_STATUS 0x4
+#define UART_FLUSH_DELAY 1000000
+
+// Contador libre: instrucciones ejecutadas por todos los harts, en dos palabras
+#define TIMER_BASE  0x09010000
+#define TIMER_LO    0x0
+#define TIMER_HI    0x4
+
+#endif
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "event.h"
+
+#define LEVEL_SHIFT(l) ((l) * EVENT_BITS)
+#define SLOT_OF(t, l)  (((t) >> LEVEL_SHIFT(l)) & (EVENT_SLOTS - 1))
+
+typedef struct Event {
+    uint64_t when;
+    event_fn fn;
+    void *arg;
+    struct Event *next, **pprev;    // lista del slot (o de overflow)
+    int level, slot;                // level == EVENT_LEVELS: overflow
+} Event;
+
+uint64_t event_deadline = EVENT_NEVER;
+
+static Event pool[EVENT_MAX];
+static Event *free_list = NULL;
+static int pool_ready = 0;
+
+// Invariante: un evento en el nivel l comparte con wheel_now los bits por
+// encima del nivel l y, si l > 0, cae en un slot posterior al actual.
+static Event *wheel[EVENT_LEVELS][EVENT_SLOTS];
+static uint64_t occupied[EVENT_LEVELS];     // bitmap de slots no vacios
+static Event *overflow = NULL;
+static uint64_t wheel_now = 0;
+
+static void list_add(Event **head, Event *e) {
+    e->next = *head;
+    e->pprev = head;
+    if (*head) (*head)->pprev = &e->next;
+    *head = e;
+}
+
+static void list_del(Event *e) {
+    *e->pprev = e->next;
+    if (e->next) e->next->pprev = e->pprev;
+    if (e->level < EVENT_LEVELS && !wheel[e->level][e->slot])
+        occupied[e->level] &= ~(1ULL << e->slot);
+}
+
+// El nivel es el del bit mas alto en que when difiere de wheel_now
+static void insert(Event *e) {
+    uint64_t diff = e->when > wheel_now ? e->when ^ wheel_now : 0;
+    int level = 0;
+    while (level < EVENT_LEVELS && (diff >> LEVEL_SHIFT(level + 1)))
+        level++;
+    e->level = level;
+    if (level == EVENT_LEVELS) {
+        list_add(&overflow, e);
+        return;
+    }
+    e->slot = e->when > wheel_now ? SLOT_OF(e->when, level) : SLOT_OF(wheel_now, 0);
+    list_add(&wheel[level][e->slot], e);
+    occupied[level] |= 1ULL << e->slot;
+}
+
+static void reinsert_list(Event **head) {
+    Event *e = *head;
+    *head = NULL;
+    while (e) {
+        Event *next = e->next;
+        insert(e);
+        e = next;
+    }
+}
+
+// Avanza la rueda: el overflow (si cambio la ventana) y los slots actuales
+// de los niveles altos se redistribuyen respecto del nuevo instante.
+static void set_now(uint64_t now) {
+    int window = (now >> LEVEL_SHIFT(EVENT_LEVELS)) != (wheel_now >> LEVEL_SHIFT(EVENT_LEVELS));
+    wheel_now = now;
+    if (window) reinsert_list(&overflow);
+    for (int l = EVENT_LEVELS - 1; l > 0; l--) {
+        int s = SLOT_OF(now, l);
+        if (occupied[l] & (1ULL << s)) {
+            occupied[l] &= ~(1ULL << s);
+            reinsert_list(&wheel[l][s]);
+        }
+    }
+}
+
+static uint64_t min_when(Event *e) {
+    uint64_t m = EVENT_NEVER;
+    for (; e; e = e->next)
+        if (e->when < m) m = e->when;
+    return m;
+}
+
+// El primer slot ocupado del nivel mas bajo tiene el proximo vencimiento.
+// En el nivel 0 cada slot es una instruccion; en los demas se recorre el slot.
+static uint64_t next_deadline(void) {
+    uint64_t mask = occupied[0] & (~0ULL << SLOT_OF(wheel_now, 0));
+    if (mask)
+        return (wheel_now & ~(uint64_t)(EVENT_SLOTS - 1)) | __builtin_ctzll(mask);
+    for (int l = 1; l < EVENT_LEVELS; l++) {
+        int cur = SLOT_OF(wheel_now, l);
+        mask = cur == EVENT_SLOTS - 1 ? 0 : occupied[l] & (~0ULL << (cur + 1));
+        if (mask) return min_when(wheel[l][__builtin_ctzll(mask)]);
+    }
+    return min_when(overflow);
+}
+
+int event_schedule(uint64_t when, event_fn fn, void *arg) {
+    if (!pool_ready) {
+        for (int i = EVENT_MAX - 1; i >= 0; i--) {
+            pool[i].next = free_list;
+            free_list = &pool[i];
+        }
+        pool_ready = 1;
+    }
+    if (!free_list) return -1;
+    Event *e = free_list;
+    free_list = e->next;
+    e->when = when;
+    e->fn = fn;
+    e->arg = arg;
+    insert(e);
+    if (when < event_deadline) event_deadline = when > wheel_now ? when : wheel_now;
+    return e - pool;
+}
+
+void event_cancel(int id) {
+    if (id < 0 || id >= EVENT_MAX || !pool[id].fn) return;
+    Event *e = &pool[id];
+    list_del(e);
+    e->fn = NULL;
+    e->next = free_list;
+    free_list = e;
+    event_deadline = next_deadline();
+}
+
+// Dispara en orden todos los eventos vencidos hasta now. Un callback puede
+// programar otros eventos, incluso para el mismo instante.
+void event_service(uint64_t now) {
+    uint64_t d;
+    while ((d = next_deadline()) <= now) {
+        if (d > wheel_now) set_now(d);
+        int s = SLOT_OF(wheel_now, 0);
+        Event *due = wheel[0][s];
+        wheel[0][s] = NULL;
+        occupied[0] &= ~(1ULL << s);
+        while (due) {
+            Event *e = due;
+            event_fn fn = e->fn;
+            due = e->next;
+            e->fn = NULL;
+            e->next = free_list;
+            free_list = e;
+            fn(e->arg);
+        }
+    }
+    if (now > wheel_now) set_now(now);
+    event_deadline = next_deadline();
+}
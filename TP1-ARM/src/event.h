@@ -0,0 +1,24 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <stdint.h>
+
+// Eventos programados por cantidad de instrucciones, en una timer wheel
+// jerarquica: EVENT_LEVELS niveles de EVENT_SLOTS slots, cada nivel con
+// slots EVENT_SLOTS veces mas anchos que el anterior. go y run ejecutan sin
+// chequear nada hasta event_deadline y recien ahi llaman a event_service.
+#define EVENT_BITS   6
+#define EVENT_SLOTS  (1 << EVENT_BITS)
+#define EVENT_LEVELS 4
+#define EVENT_MAX    256
+#define EVENT_NEVER  UINT64_MAX
+
+typedef void (*event_fn)(void *arg);
+
+extern uint64_t event_deadline;     // proximo vencimiento o EVENT_NEVER
+
+int event_schedule(uint64_t when, event_fn fn, void *arg);
+void event_cancel(int id);
+void event_service(uint64_t now);
+
+#endif
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <setjmp.h>
+#include <time.h>
+#include "fuzz.h"
+#include "coverage.h"
+#include "snapshot.h"
+#include "shell.h"
+
+#define FUZZ_MAX_INPUT 256
+#define FUZZ_DATA_BYTES 256
+#define FUZZ_INSN_WORDS 16
+#define FUZZ_CORPUS 256
+#define FUZZ_MAX_SAVED 64
+
+static const char *mode_names[] = { "regs", "data", "insn" };
+static const char *fault_names[] = { "none", "unsupported", "memory" };
+
+static uint8_t corpus[FUZZ_CORPUS][FUZZ_MAX_INPUT];
+static int corpus_len;
+static uint8_t virgin[COVERAGE_SIZE];       // aristas vistas en alguna ejecucion
+static uint64_t rng;
+
+static uint64_t next_rand(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+static size_t input_size(int mode) {
+    return mode == FUZZ_REGS ? 31 * sizeof(uint64_t) : mode == FUZZ_DATA ? FUZZ_DATA_BYTES : FUZZ_INSN_WORDS * 4;
+}
+
+// Entrada inicial: lo que ya hay en el estado marcado
+static void seed_input(int mode, uint8_t *buf) {
+    if (mode == FUZZ_REGS) {
+        memcpy(buf, CURRENT_STATE.REGS, 31 * sizeof(uint64_t));
+        return;
+    }
+    uint64_t base = mode == FUZZ_DATA ? MEM_DATA_START : CURRENT_STATE.PC;
+    for (size_t i = 0; i < input_size(mode); i += 4) {
+        uint32_t w = mem_read_32(base + i);
+        memcpy(buf + i, &w, 4);
+    }
+}
+
+static void apply_input(int mode, const uint8_t *buf) {
+    if (mode == FUZZ_REGS) {
+        memcpy(CURRENT_STATE.REGS, buf, 31 * sizeof(uint64_t));
+        NEXT_STATE = CURRENT_STATE;
+        return;
+    }
+    uint64_t base = mode == FUZZ_DATA ? MEM_DATA_START : CURRENT_STATE.PC;
+    for (size_t i = 0; i < input_size(mode); i += 4) {
+        uint32_t w;
+        memcpy(&w, buf + i, 4);
+        mem_write_32(base + i, w);
+    }
+}
+
+// Mutaciones tipo havoc: 1 a 8 operaciones sobre una copia de un elemento del corpus
+static void mutate(uint8_t *buf, size_t len) {
+    static const int64_t interesting[] = { 0, 1, -1, 2, 16, 64, 127, 128, 255, 256, 4096, 0x7FFFFFFF,
+                                           INT64_MAX, INT64_MIN, MEM_DATA_START, MEM_TEXT_START };
+    int n = 1 + next_rand() % 8;
+    for (int k = 0; k < n; k++) {
+        uint64_t r = next_rand();
+        size_t pos = (r >> 8) % len;
+        switch (r % 6) {
+        case 0: buf[pos] ^= 1 << ((r >> 40) & 7); break;
+        case 1: buf[pos] = r >> 32; break;
+        case 2: buf[pos] += (int8_t)((r >> 32) % 35) - 17; break;
+        case 3: {
+            size_t w = pos & ~(size_t)7;
+            int64_t v = interesting[(r >> 32) % (sizeof(interesting) / sizeof(interesting[0]))];
+            memcpy(buf + w, &v, w + 8 <= len ? 8 : len - w);
+            break;
+        }
+        case 4: {
+            const uint8_t *other = corpus[(r >> 32) % corpus_len];
+            size_t from = (r >> 16) % len;
+            memcpy(buf + from, other + from, len - from);
+            break;
+        }
+        default: {
+            size_t w = pos & ~(size_t)3;
+            uint32_t v;
+            memcpy(&v, buf + w, 4);
+            v += (int32_t)((r >> 32) % 9) - 4;
+            memcpy(buf + w, &v, 4);
+            break;
+        }
+        }
+    }
+}
+
+// Marca como vistas las aristas del ultimo run; devuelve cuantas eran nuevas
+static uint32_t merge_new_edges(void) {
+    uint32_t fresh = 0;
+    const uint64_t *m = (const uint64_t *)coverage_map;
+    for (uint32_t w = 0; w < COVERAGE_SIZE / 8; w++) {
+        if (!m[w]) continue;
+        for (uint32_t i = w * 8; i < w * 8 + 8; i++) {
+            if (coverage_map[i] && !virgin[i]) {
+                virgin[i] = 1;
+                fresh++;
+            }
+        }
+    }
+    return fresh;
+}
+
+static void save_input(const char *kind, int mode, int n, const uint8_t *buf) {
+    char path[64];
+    snprintf(path, sizeof(path), "%s-%s-%03d.bin", kind, mode_names[mode], n);
+    FILE *f = fopen(path, "wb");
+    if (!f) return;
+    fwrite(buf, 1, input_size(mode), f);
+    fclose(f);
+}
+
+// Ejecuta desde el estado marcado hasta HLT, un fallo o budget instrucciones
+static int execute(int mode, const uint8_t *input, uint64_t budget) {
+    jmp_buf env;
+    volatile int fault;
+
+    snapshot_reset();
+    coverage_clear();
+    apply_input(mode, input);
+    uint64_t stop = INSTRUCTION_COUNT + budget;
+    FAULT_JMP = &env;
+    fault = setjmp(env);
+    if (!fault)
+        while (RUN_BIT && INSTRUCTION_COUNT < stop)
+            cycle();
+    FAULT_JMP = NULL;
+    return fault;
+}
+
+int fuzz_run(int mode, uint64_t iterations, uint64_t budget, uint64_t seed) {
+    uint8_t input[FUZZ_MAX_INPUT];
+    uint64_t faults[3] = {0}, hangs = 0;
+    int saved = 0;
+    struct timespec t0, t1;
+    size_t len = input_size(mode);
+
+    if (!RUN_BIT) {
+        printf("Can't fuzz, Simulator is halted\n\n");
+        return -1;
+    }
+    snapshot_mark();
+    rng = seed ? seed : 0x9E3779B97F4A7C15ULL;
+    memset(virgin, 0, sizeof(virgin));
+    corpus_len = 1;
+    seed_input(mode, corpus[0]);
+    int was_enabled = coverage_enabled;
+    static uint8_t saved_map[COVERAGE_SIZE];
+    memcpy(saved_map, coverage_map, COVERAGE_SIZE);
+    coverage_enabled = 1;
+
+    execute(mode, corpus[0], budget);
+    merge_new_edges();
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint64_t it = 0; it < iterations; it++) {
+        memcpy(input, corpus[next_rand() % corpus_len], len);
+        mutate(input, len);
+        int fault = execute(mode, input, budget);
+        int hang = !fault && RUN_BIT;
+        uint32_t fresh = merge_new_edges();
+
+        if (fault) faults[fault]++;
+        if (hang) hangs++;
+        if (fresh && !fault && corpus_len < FUZZ_CORPUS)
+            memcpy(corpus[corpus_len++], input, len);
+        // Se guardan el primer fallo de cada tipo y los que llegan a aristas nuevas
+        int first = fault ? faults[fault] == 1 : hangs == 1;
+        if ((fresh || first) && (fault || hang) && saved < FUZZ_MAX_SAVED)
+            save_input(fault ? "crash" : "hang", mode, saved++, input);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    snapshot_reset();
+    coverage_enabled = was_enabled;
+    memcpy(coverage_map, saved_map, COVERAGE_SIZE);
+    printf("Fuzzed %s: %" PRIu64 " execs in %.2f s (%.0f execs/s)\n", mode_names[mode], iterations, secs,
+           secs > 0 ? iterations / secs : 0.0);
+    printf("Edges %u, corpus %d, hangs %" PRIu64 ", faults: %s %" PRIu64 ", %s %" PRIu64
+           ", %d inputs saved\n\n", coverage_count(virgin), corpus_len, hangs, fault_names[FAULT_UNSUPPORTED],
+           faults[FAULT_UNSUPPORTED], fault_names[FAULT_MEMORY], faults[FAULT_MEMORY], saved);
+    return 0;
+}
@@ -0,0 +1,13 @@
+#ifndef FUZZ_H
+#define FUZZ_H
+
+#include <stdint.h>
+
+// Fuzzer en proceso: muta una entrada (registros, datos o instrucciones),
+// la ejecuta desde el estado actual y vuelve a el con el reset por paginas
+// sucias. Las entradas que cubren aristas nuevas pasan al corpus.
+enum { FUZZ_REGS, FUZZ_DATA, FUZZ_INSN };
+
+int fuzz_run(int mode, uint64_t iterations, uint64_t budget, uint64_t seed);
+
+#endif
@@ -1,22 +1,38 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <stdbool.h>
+#include <inttypes.h>
 #include "shell.h"
 #include "decode.h"
 #include "handlers.h"
+#include "bpred.h"
+#include "coverage.h"
+#include "cache.h"
+#include "hart.h"
+#include "syscall.h"
+#include "device.h"
 
-extern int branch_taken;
+extern HART_LOCAL int branch_taken;
 
 void handle_hlt(uint32_t instr) {
     RUN_BIT = 0;
+    device_flush_all();
+}
+
+// SVC #imm: el inmediato se ignora, como en Linux. El resto del grupo
+// (HVC, SMC) no esta soportado.
+void handle_svc(uint32_t instr) {
+    if ((instr & 0x1F) != 1) unsupported_instruction(instr);
+    syscall_dispatch();
 }
 
 void handle_adds_imm(uint32_t instr) {
     uint32_t imm12, shift, d, n;
     decode_i_group(instr, &imm12, &shift, &d, &n);
-    uint64_t res = calculate_mathOps(n, 0, shift, imm12, 0, 1);
-    NEXT_STATE.REGS[d] = res;
+    uint64_t res = calculate_mathOps(SP_R(n), 0, shift, imm12, 0, 1);
+    NEXT_STATE.REGS[ZR_W(d)] = res;
     update_flags(res);
 }
 
@@ -24,16 +40,16 @@ void handle_adds_reg(uint32_t instr) {
     uint32_t opt, imm3, d, n, m;
     decode_r_group(instr, &opt, &imm3, &d, &n, &m);
     uint64_t res = calculate_mathOps(n, m, opt, imm3, 0, 0);
-    NEXT_STATE.REGS[d] = res;
+    NEXT_STATE.REGS[ZR_W(d)] = res;
     update_flags(res);
 }
 
 void handle_subs_imm(uint32_t instr) {
     uint32_t imm12, shift, d, n;
     decode_i_group(instr, &imm12, &shift, &d, &n);
-    uint64_t res = calculate_mathOps(n, 0, shift, imm12, 1, 1);
+    uint64_t res = calculate_mathOps(SP_R(n), 0, shift, imm12, 1, 1);
     update_flags(res);
-    if (d != 31) NEXT_STATE.REGS[d] = res;
+    NEXT_STATE.REGS[ZR_W(d)] = res;
 }
 
 void handle_subs_reg(uint32_t instr) {
@@ -41,16 +57,16 @@ void handle_subs_reg(uint32_t instr) {
     decode_r_group(instr, &opt, &imm3, &d, &n, &m);
     uint64_t res = calculate_mathOps(n, m, opt, imm3, 1, 0);
     update_flags(res);
-    if (d != 31) NEXT_STATE.REGS[d] = res;
+    NEXT_STATE.REGS[ZR_W(d)] = res;
 }
 
 void handle_ands(uint32_t instr) {
     uint32_t imm6, d, n, m;
     decode_shifted_register(instr, &imm6, &d, &n, &m);
     uint64_t op1 = CURRENT_STATE.REGS[n];
-    uint64_t op2 = CURRENT_STATE.REGS[m] <<= imm6;
+    uint64_t op2 = CURRENT_STATE.REGS[m] << imm6;
     uint64_t res = op1 & op2;
-    NEXT_STATE.REGS[d] = res;
+    NEXT_STATE.REGS[ZR_W(d)] = res;
     update_flags(res);
 }
 
@@ -61,72 +77,118 @@ void handle_eor(uint32_t instr) {
     uint64_t op2 = CURRENT_STATE.REGS[m];
     op2 = (imm6 == 0) ? op2 : (op2 << imm6); 
     uint64_t res = op1 ^ op2;
-    NEXT_STATE.REGS[d] = res;
+    NEXT_STATE.REGS[ZR_W(d)] = res;
 }
 
 void handle_orr(uint32_t instr) {
     uint32_t imm6, d, n, m;
     decode_shifted_register(instr, &imm6, &d, &n, &m);
-    NEXT_STATE.REGS[d] = CURRENT_STATE.REGS[n] | CURRENT_STATE.REGS[m];
+    NEXT_STATE.REGS[ZR_W(d)] = CURRENT_STATE.REGS[n] | CURRENT_STATE.REGS[m];
 }
 
 void handle_b(uint32_t instr) {
     int32_t imm26 = instr & 0x3FFFFFF;
     int64_t offset = ((int64_t)(imm26 << 6)) >> 4;
+    if (coverage_enabled) coverage_edge(CURRENT_STATE.PC + offset);
     NEXT_STATE.PC += offset - 4;
 }
 
 void handle_br(uint32_t instr) {
     uint32_t n = (instr >> 5) & 0x1F;
+    if (bpred_enabled) bpred_indirect(CURRENT_STATE.PC, CURRENT_STATE.REGS[n]);
+    if (coverage_enabled) coverage_edge(CURRENT_STATE.REGS[n]);
     NEXT_STATE.PC = CURRENT_STATE.REGS[n] - 4;
 }
 
-void handle_stur(uint32_t instr) {
+// Direccion de LDUR/STUR y variantes. Bits 11:10: 00 sin escalar,
+// 01 post-indexado, 11 pre-indexado; los indexados escriben la base.
+// 10 es LDTR/STTR (acceso no privilegiado), que no se implementa.
+static uint64_t ls_address(uint32_t instr) {
     int32_t imm9, n, t;
+    uint32_t mode = (instr >> 10) & 3;
+    if (mode == 2) unsupported_instruction(instr);
     decode_mem_access(instr, &imm9, &n, &t);
-    imm9 = sign_extend(imm9, 64);
-    uint64_t addr = CURRENT_STATE.REGS[n] + imm9;
-    mem_write_64(addr, CURRENT_STATE.REGS[t]);
+    uint64_t base = CURRENT_STATE.REGS[SP_R(n)];
+    uint64_t addr = base + sign_extend(imm9, 9);
+    if (mode & 1) {
+        NEXT_STATE.REGS[SP_R(n)] = addr;
+        if (mode == 1) addr = base;
+    }
+    return addr;
+}
+
+void handle_stur(uint32_t instr) {
+    mem_write_64(ls_address(instr), CURRENT_STATE.REGS[instr & 0x1F]);
 }
 
 void handle_sturb(uint32_t instr) {
-    int32_t imm9, n, t;
-    decode_mem_access(instr, &imm9, &n, &t);
-    imm9 = sign_extend(imm9, 64);
-    uint64_t addr = CURRENT_STATE.REGS[n] + imm9;
-    mem_write_8(addr, (uint8_t)CURRENT_STATE.REGS[t]);
+    mem_write_8(ls_address(instr), (uint8_t)CURRENT_STATE.REGS[instr & 0x1F]);
 }
 
 void handle_sturh(uint32_t instr) {
-    int32_t imm9, n, t;
-    decode_mem_access(instr, &imm9, &n, &t);
-    imm9 = sign_extend(imm9, 64);
-    uint64_t addr = CURRENT_STATE.REGS[n] + imm9;
-    mem_write_16(addr, (uint16_t)CURRENT_STATE.REGS[t]);
+    mem_write_16(ls_address(instr), (uint16_t)CURRENT_STATE.REGS[instr & 0x1F]);
 }
 
 void handle_ldur(uint32_t instr) {
-    int32_t imm9, n, t;
-    decode_mem_access(instr, &imm9, &n, &t);
-    imm9 = sign_extend(imm9, 64);
-    uint64_t addr = CURRENT_STATE.REGS[n] + imm9;
-    NEXT_STATE.REGS[t] = mem_read_64(addr);
+    uint64_t addr = ls_address(instr);
+    NEXT_STATE.REGS[ZR_W(instr & 0x1F)] = mem_read_64(addr);
 }
 
 void handle_ldurb(uint32_t instr) {
-    int32_t imm9, n, t;
-    decode_mem_access(instr, &imm9, &n, &t);
-    imm9 = sign_extend(imm9, 64);
-    uint64_t addr = CURRENT_STATE.REGS[n] + imm9;
-    NEXT_STATE.REGS[t] = mem_read_8(addr);
+    uint64_t addr = ls_address(instr);
+    NEXT_STATE.REGS[ZR_W(instr & 0x1F)] = mem_read_8(addr);
 }
 
 void handle_ldurh(uint32_t instr) {
-    int32_t imm9, n, t;
-    decode_mem_access(instr, &imm9, &n, &t);
-    imm9 = sign_extend(imm9, 64);
-    uint64_t addr = CURRENT_STATE.REGS[n] + imm9;
-    NEXT_STATE.REGS[t] = mem_read_16(addr);
+    uint64_t addr = ls_address(instr);
+    NEXT_STATE.REGS[ZR_W(instr & 0x1F)] = mem_read_16(addr);
+}
+
+// LDP/STP de 64 bits: imm7 escalado por 8. Bits 24:23: 01 post-indexado,
+// 10 offset, 11 pre-indexado.
+static uint64_t pair_address(uint32_t instr) {
+    uint32_t n = (instr >> 5) & 0x1F, mode = (instr >> 23) & 3;
+    uint64_t base = CURRENT_STATE.REGS[SP_R(n)];
+    uint64_t addr = base + sign_extend((instr >> 15) & 0x7F, 7) * 8;
+    if (mode & 1) {
+        NEXT_STATE.REGS[SP_R(n)] = addr;
+        if (mode == 1) addr = base;
+    }
+    return addr;
+}
+
+// Un solo chequeo de region para los 16 bytes. Si el par no cae entero en
+// una region (dispositivos, limite de region) se hacen dos accesos normales.
+void handle_stp(uint32_t instr) {
+    uint64_t addr = pair_address(instr);
+    uint64_t v[2] = { CURRENT_STATE.REGS[instr & 0x1F], CURRENT_STATE.REGS[(instr >> 10) & 0x1F] };
+    uint8_t *p = mem_region_ptr(addr, 16, 1);
+    if (p) {
+        if (cache_enabled) cache_data_access(addr, 16, 1);
+        memcpy(p, v, sizeof(v));
+    } else {
+        mem_write_64(addr, v[0]);
+        mem_write_64(addr + 8, v[1]);
+    }
+    mem_last_addr = addr;
+    mem_last_value = v[0];
+}
+
+void handle_ldp(uint32_t instr) {
+    uint64_t addr = pair_address(instr);
+    uint64_t v[2];
+    uint8_t *p = mem_region_ptr(addr, 16, 0);
+    if (p) {
+        if (cache_enabled) cache_data_access(addr, 16, 0);
+        memcpy(v, p, sizeof(v));
+    } else {
+        v[0] = mem_read_64(addr);
+        v[1] = mem_read_64(addr + 8);
+    }
+    mem_last_addr = addr;
+    mem_last_value = v[0];
+    NEXT_STATE.REGS[ZR_W(instr & 0x1F)] = v[0];
+    NEXT_STATE.REGS[ZR_W((instr >> 10) & 0x1F)] = v[1];
 }
 
 void handle_b_cond(uint32_t instr) {
@@ -142,6 +204,8 @@ void handle_b_cond(uint32_t instr) {
         case 0xC: if ((CURRENT_STATE.FLAG_Z == 0) && (CURRENT_STATE.FLAG_N == 0)) branch_taken = 1; break;
         case 0xD: if ((CURRENT_STATE.FLAG_Z == 1) || (CURRENT_STATE.FLAG_N != 0)) branch_taken = 1; break;
     }
+    if (bpred_enabled) bpred_conditional(CURRENT_STATE.PC, branch_taken, CURRENT_STATE.PC + offset);
+    if (coverage_enabled) coverage_edge(branch_taken ? CURRENT_STATE.PC + offset : CURRENT_STATE.PC + 4);
     if (branch_taken)    NEXT_STATE.PC = CURRENT_STATE.PC + offset;
 }
 
@@ -150,32 +214,34 @@ void handle_movz(uint32_t instr) {
     uint32_t hw = (instr >> 21) & 0x3;
     uint32_t imm16 = (instr >> 5) & 0xFFFF;
     if (hw != 0)    printf("MOVZ: solo se implementa el caso hw == 0.\n");
-    NEXT_STATE.REGS[d] = imm16;
+    NEXT_STATE.REGS[ZR_W(d)] = imm16;
 }
 
 void handle_add_imm(uint32_t instr) {
     uint32_t imm12, shift, d, n;
     decode_i_group(instr, &imm12, &shift, &d, &n);
     uint64_t imm = (shift == 1) ? (imm12 << 12) : imm12;
-    NEXT_STATE.REGS[d] = CURRENT_STATE.REGS[n] + imm; 
+    NEXT_STATE.REGS[SP_R(d)] = CURRENT_STATE.REGS[SP_R(n)] + imm;
 }
 
 void handle_add_reg(uint32_t instr) {
     uint32_t opt, imm3, d, n, m;
     decode_r_group(instr, &opt, &imm3, &d, &n, &m);
     uint64_t res = CURRENT_STATE.REGS[n] + CURRENT_STATE.REGS[m];
-    NEXT_STATE.REGS[d] = res;
+    NEXT_STATE.REGS[ZR_W(d)] = res;
 }
 
 void handle_mul(uint32_t instr) {
     uint32_t opt, imm3, d, n, m;
     decode_r_group(instr, &opt, &imm3, &d, &n, &m);
-    NEXT_STATE.REGS[d] = CURRENT_STATE.REGS[n] * CURRENT_STATE.REGS[m];
+    NEXT_STATE.REGS[ZR_W(d)] = CURRENT_STATE.REGS[n] * CURRENT_STATE.REGS[m];
 }
 
 void handle_cbz(uint32_t instr) {
     uint32_t t, offset;
     decode_conditional_branch(instr, &t, &offset);
+    if (bpred_enabled) bpred_conditional(CURRENT_STATE.PC, CURRENT_STATE.REGS[t] == 0, CURRENT_STATE.PC + offset);
+    if (coverage_enabled) coverage_edge(CURRENT_STATE.REGS[t] == 0 ? CURRENT_STATE.PC + offset : CURRENT_STATE.PC + 4);
     if (CURRENT_STATE.REGS[t] == 0){
         branch_taken = 1;
         NEXT_STATE.PC = CURRENT_STATE.PC + offset;
@@ -185,6 +251,8 @@ void handle_cbz(uint32_t instr) {
 void handle_cbnz(uint32_t instr) {
     uint32_t t, offset;
     decode_conditional_branch(instr, &t, &offset);
+    if (bpred_enabled) bpred_conditional(CURRENT_STATE.PC, CURRENT_STATE.REGS[t] != 0, CURRENT_STATE.PC + offset);
+    if (coverage_enabled) coverage_edge(CURRENT_STATE.REGS[t] != 0 ? CURRENT_STATE.PC + offset : CURRENT_STATE.PC + 4);
     if (CURRENT_STATE.REGS[t] != 0) {
         branch_taken = 1;
         NEXT_STATE.PC = CURRENT_STATE.PC + offset;
@@ -197,9 +265,90 @@ void handle_shift(uint32_t instr) {
     decode_lsl_lsr(instr, &is_lsr, &shift_amt, &rd, &rn);
 
     if (is_lsr) {
-        NEXT_STATE.REGS[rd] = (CURRENT_STATE.REGS[rn] >> shift_amt);
+        NEXT_STATE.REGS[ZR_W(rd)] = (CURRENT_STATE.REGS[rn] >> shift_amt);
     } else {
-        NEXT_STATE.REGS[rd] = (CURRENT_STATE.REGS[rn] << shift_amt);
+        NEXT_STATE.REGS[ZR_W(rd)] = (CURRENT_STATE.REGS[rn] << shift_amt);
     }
 }
 
+
+// Puntero host para un acceso atomico de 8 bytes; desalineado o fuera de
+// las regiones es un fallo de memoria
+static uint64_t *atomic_ptr(uint64_t addr, int is_write) {
+    uint64_t *p = (addr & 7) ? NULL : (uint64_t *)mem_host_ptr(addr, 8, is_write);
+    if (!p) {
+        if (FAULT_JMP) longjmp(*FAULT_JMP, FAULT_MEMORY);
+        printf("Atomic access fault at 0x%" PRIx64 "\n", addr);
+        exit(1);
+    }
+    if (cache_enabled) cache_data_access(addr, 8, is_write);
+    mem_last_addr = addr;
+    return p;
+}
+
+void handle_ldxr(uint32_t instr) {
+    uint32_t n = (instr >> 5) & 0x1F, t = instr & 0x1F;
+    uint64_t addr = CURRENT_STATE.REGS[SP_R(n)];
+    uint64_t value = __atomic_load_n(atomic_ptr(addr, 0), __ATOMIC_SEQ_CST);
+    NEXT_STATE.EXCL_VALID = 1;
+    NEXT_STATE.EXCL_ADDR = addr;
+    NEXT_STATE.EXCL_VALUE = value;
+    mem_last_value = value;
+    NEXT_STATE.REGS[ZR_W(t)] = value;
+}
+
+// El monitor exclusivo vive en CPU_State, asi viaja con cada hart. STXR solo
+// escribe si la memoria conserva el valor que leyo LDXR (CAS en el host).
+void handle_stxr(uint32_t instr) {
+    uint32_t s = (instr >> 16) & 0x1F, n = (instr >> 5) & 0x1F, t = instr & 0x1F;
+    uint64_t addr = CURRENT_STATE.REGS[SP_R(n)];
+    uint64_t expected = CURRENT_STATE.EXCL_VALUE;
+    int ok = 0;
+    if (CURRENT_STATE.EXCL_VALID && CURRENT_STATE.EXCL_ADDR == addr)
+        ok = __atomic_compare_exchange_n(atomic_ptr(addr, 1), &expected, CURRENT_STATE.REGS[t], 0,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    NEXT_STATE.EXCL_VALID = 0;
+    mem_last_addr = addr;
+    mem_last_value = CURRENT_STATE.REGS[t];
+    NEXT_STATE.REGS[ZR_W(s)] = !ok;
+}
+
+// CAS/CASA/CASL/CASAL: todas secuencialmente consistentes en el host
+void handle_cas(uint32_t instr) {
+    uint32_t s = (instr >> 16) & 0x1F, n = (instr >> 5) & 0x1F, t = instr & 0x1F;
+    uint64_t addr = CURRENT_STATE.REGS[SP_R(n)];
+    uint64_t expected = CURRENT_STATE.REGS[s];
+    __atomic_compare_exchange_n(atomic_ptr(addr, 1), &expected, CURRENT_STATE.REGS[t], 0,
+                                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    mem_last_value = expected;
+    NEXT_STATE.REGS[ZR_W(s)] = expected;
+}
+
+// LDADD/LDCLR/LDEOR/LDSET (o3 = 0, opc 0-3) y SWP (o3 = 1, opc 0); Xt recibe el valor anterior
+void handle_ldop(uint32_t instr) {
+    uint32_t s = (instr >> 16) & 0x1F, n = (instr >> 5) & 0x1F, t = instr & 0x1F;
+    uint32_t o3 = (instr >> 15) & 1, opc = (instr >> 12) & 7;
+    uint64_t addr = CURRENT_STATE.REGS[SP_R(n)];
+    uint64_t v = CURRENT_STATE.REGS[s], old;
+
+    if (((instr >> 10) & 3) != 0 || (o3 && opc != 0) || opc > 3) {
+        unsupported_instruction(instr);
+        return;
+    }
+    uint64_t *p = atomic_ptr(addr, 1);
+    if (o3) old = __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST);
+    else if (opc == 0) old = __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+    else if (opc == 1) old = __atomic_fetch_and(p, ~v, __ATOMIC_SEQ_CST);
+    else if (opc == 2) old = __atomic_fetch_xor(p, v, __ATOMIC_SEQ_CST);
+    else old = __atomic_fetch_or(p, v, __ATOMIC_SEQ_CST);
+    mem_last_value = old;
+    NEXT_STATE.REGS[ZR_W(t)] = old;
+}
+
+// NOP, YIELD, WFE, WFI, SEV... (CRm:op2 en bits 11:5). YIELD, WFE y WFI
+// ceden el hart al scheduler; sin otro hart que despertar, WFE y WFI no
+// bloquean. El resto de los hints no tiene efecto.
+void handle_hint(uint32_t instr) {
+    uint32_t op = (instr >> 5) & 0x7F;
+    if (op >= 1 && op <= 3) hart_yield = 1;
+}
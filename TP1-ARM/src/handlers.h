@@ -3,7 +3,45 @@
 
 #include <stdint.h>
 
+typedef void (*InstructionHandler)(uint32_t);
+
+// Clase de instruccion; las de CLS_BRANCH en adelante cierran un bloque basico
+typedef enum {
+    CLS_ALU, CLS_MUL, CLS_LOAD, CLS_STORE, CLS_BRANCH, CLS_COND_BRANCH, CLS_SYS
+} InstrClass;
+
+// Operandos de registro de cada instruccion, para los modelos de timing.
+// OP_RD escribe bits 4:0, OP_RT los lee; OP_RM lee bits 20:16 y OP_RM_W
+// los escribe; OP_RT2 y OP_RT2_W lo mismo con bits 14:10 (pares);
+// OP_RN_WB: los modos pre/post-indexados escriben la base; *_SP: el 31 es
+// SP y no XZR.
+enum {
+    OP_RD = 1 << 0, OP_RT = 1 << 1, OP_RN = 1 << 2, OP_RM = 1 << 3,
+    OP_RD_SP = 1 << 4, OP_RN_SP = 1 << 5, OP_FLAGS_R = 1 << 6, OP_FLAGS_W = 1 << 7,
+    OP_RM_W = 1 << 8, OP_RT2 = 1 << 9, OP_RT2_W = 1 << 10, OP_RN_WB = 1 << 11
+};
+
+typedef struct {
+    uint32_t pattern;
+    int length;
+    InstructionHandler handler;
+    const char *name;
+    InstrClass cls;
+    int width;                  // bytes accedidos por loads/stores, 0 si no aplica
+    int ops;
+} InstructionEntry;
+
+#define MAX_OPCODES 64
+
+// Tabla de opcodes (sim.c); el indice de cada entrada identifica al handler
+extern const InstructionEntry OPCODE_TABLE[];
+extern const int OPCODE_COUNT;
+
+const InstructionEntry *decode_instruction(uint32_t instruction);
+void unsupported_instruction(uint32_t instr);
+
 void handle_hlt(uint32_t instr);
+void handle_svc(uint32_t instr);
 void handle_adds_imm(uint32_t instr);
 void handle_adds_reg(uint32_t instr);
 void handle_subs_imm(uint32_t instr);
@@ -26,6 +64,13 @@ void handle_shift(uint32_t instr);
 void handle_sturb(uint32_t instr);
 void handle_sturh(uint32_t instr);
 void handle_ldurb(uint32_t instr);
+void handle_ldxr(uint32_t instr);
+void handle_stxr(uint32_t instr);
+void handle_cas(uint32_t instr);
+void handle_ldop(uint32_t instr);
+void handle_hint(uint32_t instr);
 void handle_ldurh(uint32_t instr);
+void handle_stp(uint32_t instr);
+void handle_ldp(uint32_t instr);
 
 #endif
@@ -0,0 +1,292 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <time.h>
+#include <ucontext.h>
+#include "hart.h"
+#include "shell.h"
+
+#define HART_STACK_SIZE (64 * 1024)
+#define HART_DUMP_MAX 32
+
+typedef struct {
+    CPU_State state;
+    int run_bit;
+    uint64_t count;             // instrucciones ejecutadas por este hart
+    ucontext_t ctx;             // corrutina del scheduler cooperativo
+    char *stack;
+} Hart;
+
+int hart_count = 1;
+HART_LOCAL int hart_yield = 0;
+
+static Hart harts[HART_MAX];
+static int current = 0;
+static uint64_t quantum = 1000;
+static int threaded = 0;
+
+// Scheduler: cola FIFO de harts listos y la corrutina que esta corriendo
+static int ready[HART_MAX];
+static int ready_head, ready_len;
+static ucontext_t sched_ctx;
+static uint64_t slice;
+
+static void save_current(void) {
+    harts[current].state = CURRENT_STATE;
+}
+
+static void load_hart(int id) {
+    CURRENT_STATE = NEXT_STATE = harts[id].state;
+    RUN_BIT = harts[id].run_bit;
+}
+
+static int any_running(void) {
+    for (int i = 0; i < hart_count; i++)
+        if (harts[i].run_bit) return 1;
+    return 0;
+}
+
+static void check_threads(void) {
+    if (threaded && hart_count > HART_THREADS_MAX)
+        printf("Too many harts for host threads (max %d), using the scheduler\n\n", HART_THREADS_MAX);
+}
+
+// Cambia la cantidad de harts. El hart 0 conserva el estado actual; el hart
+// i arranca en la entrada del programa i % PROGRAM_COUNT con X0 = i.
+int hart_configure(int n) {
+    if (n < 1 || n > HART_MAX) return -1;
+    if (hart_count == 1) {
+        harts[0].state = CURRENT_STATE;
+        harts[0].run_bit = RUN_BIT;
+        harts[0].count = INSTRUCTION_COUNT;
+    } else {
+        save_current();
+    }
+    for (int i = n; i < hart_count; i++) {
+        free(harts[i].stack);
+        harts[i].stack = NULL;
+    }
+    for (int i = hart_count; i < n; i++) {
+        memset(&harts[i], 0, sizeof(Hart));
+        harts[i].state.PC = PROGRAM_COUNT ? PROGRAM_ENTRY[i % PROGRAM_COUNT] : MEM_TEXT_START;
+        harts[i].state.REGS[0] = i;
+        harts[i].run_bit = TRUE;
+    }
+    hart_count = n;
+    current = 0;
+    check_threads();
+    load_hart(0);
+    RUN_BIT = any_running();
+    return 0;
+}
+
+void hart_set_quantum(uint64_t q) {
+    quantum = q ? q : 1;
+}
+
+void hart_set_threads(int on) {
+    threaded = on;
+    check_threads();
+}
+
+int hart_threads_enabled(void) {
+    return threaded;
+}
+
+int hart_select(int id) {
+    if (id < 0 || id >= hart_count) return -1;
+    save_current();
+    current = id;
+    int run = any_running();
+    load_hart(id);
+    RUN_BIT = run;
+    return 0;
+}
+
+// Modo relajado: cada hart en un thread del host con su estado thread-local.
+// Los stores se ven en el orden que de el host. Los modelos de analisis con
+// estado global (ooo, pipeline, cache, bpred, hot, record, trace) no se pueden
+// prender en este modo; los contadores de stats son aproximados. Cada thread suma sus
+// instrucciones a shared_count cada HART_SYNC_BATCH y todos paren cuando
+// el total llega a thread_target (el proximo evento), con un desfasaje de
+// a lo sumo un lote por thread.
+#define HART_SYNC_BATCH 1024
+
+static uint64_t shared_count, thread_target;
+static int in_threads = 0;
+static HART_LOCAL uint64_t thread_flushed;
+static double thread_secs = 0;
+static uint64_t thread_instrs = 0;
+
+uint64_t hart_clock(void) {
+    if (!in_threads) return INSTRUCTION_COUNT;
+    return __atomic_load_n(&shared_count, __ATOMIC_RELAXED) + INSTRUCTION_COUNT - thread_flushed;
+}
+
+static void *hart_thread(void *arg) {
+    Hart *h = arg;
+    CURRENT_STATE = NEXT_STATE = h->state;
+    RUN_BIT = h->run_bit;
+    INSTRUCTION_COUNT = thread_flushed = 0;
+    while (RUN_BIT) {
+        while (RUN_BIT && INSTRUCTION_COUNT - thread_flushed < HART_SYNC_BATCH)
+            cycle();
+        uint64_t total = __atomic_add_fetch(&shared_count, INSTRUCTION_COUNT - thread_flushed, __ATOMIC_RELAXED);
+        thread_flushed = INSTRUCTION_COUNT;
+        if (total >= thread_target) break;
+    }
+    h->state = CURRENT_STATE;
+    h->run_bit = RUN_BIT;
+    h->count += INSTRUCTION_COUNT;
+    return NULL;
+}
+
+static uint64_t run_threads(uint64_t budget) {
+    static pthread_t threads[HART_MAX];
+    uint64_t base = INSTRUCTION_COUNT;
+    struct timespec t0, t1;
+
+    shared_count = base;
+    thread_target = budget > UINT64_MAX - base ? UINT64_MAX : base + budget;
+    in_threads = 1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < hart_count; i++)
+        if (harts[i].run_bit) pthread_create(&threads[i], NULL, hart_thread, &harts[i]);
+    for (int i = 0; i < hart_count; i++)
+        if (harts[i].run_bit) pthread_join(threads[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    in_threads = 0;
+    INSTRUCTION_COUNT = shared_count;
+
+    // Una corrida puede venir en varios tramos (uno por evento): se informa al final
+    thread_secs += (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    thread_instrs += shared_count - base;
+    if (!any_running()) {
+        printf("%d harts on host threads: %.3f s, %.2f MIPS aggregate\n\n", hart_count, thread_secs,
+               thread_secs > 0 ? thread_instrs / thread_secs / 1e6 : 0.0);
+        thread_secs = 0;
+        thread_instrs = 0;
+    }
+    return shared_count - base;
+}
+
+// Cuerpo de cada corrutina: ejecuta hasta agotar el quantum, parar o pedir
+// yield (YIELD/WFE/WFI) y vuelve al scheduler. El estado de la maquina lo
+// cargan y guardan el scheduler en los globales; la corrutina no termina nunca.
+static void hart_body(int id) {
+    for (;;) {
+        while (RUN_BIT && slice && !hart_yield) {
+            cycle();
+            slice--;
+        }
+        swapcontext(&harts[id].ctx, &sched_ctx);
+    }
+}
+
+static void ready_push(int id) {
+    ready[(ready_head + ready_len++) % HART_MAX] = id;
+}
+
+static int ready_pop(void) {
+    int id = ready[ready_head];
+    ready_head = (ready_head + 1) % HART_MAX;
+    ready_len--;
+    return id;
+}
+
+// Scheduler cooperativo en un solo thread: saca el primer hart listo, le da
+// un quantum y lo vuelve a encolar al final si sigue corriendo. El orden
+// depende solo del programa y del quantum, asi las corridas son reproducibles.
+static uint64_t run_coroutines(uint64_t budget) {
+    uint64_t done = 0;
+
+    ready_head = ready_len = 0;
+    for (int i = 0; i < hart_count; i++)
+        if (harts[i].run_bit) ready_push(i);
+
+    while (done < budget && ready_len) {
+        int id = ready_pop();
+        Hart *h = &harts[id];
+        if (!h->stack) {
+            h->stack = malloc(HART_STACK_SIZE);
+            getcontext(&h->ctx);
+            h->ctx.uc_stack.ss_sp = h->stack;
+            h->ctx.uc_stack.ss_size = HART_STACK_SIZE;
+            h->ctx.uc_link = NULL;
+            makecontext(&h->ctx, (void (*)(void))hart_body, 1, id);
+        }
+        load_hart(id);
+        slice = budget - done < quantum ? budget - done : quantum;
+        hart_yield = 0;
+        uint64_t start = INSTRUCTION_COUNT;
+        swapcontext(&sched_ctx, &h->ctx);
+
+        h->state = CURRENT_STATE;
+        h->run_bit = RUN_BIT;
+        h->count += INSTRUCTION_COUNT - start;
+        done += INSTRUCTION_COUNT - start;
+        if (h->run_bit) ready_push(id);
+    }
+    return done;
+}
+
+// Ejecuta hasta budget instrucciones en total (UINT64_MAX: hasta que todos
+// paren) con el scheduler de corrutinas o, en modo relajado, un thread por hart.
+uint64_t hart_run(uint64_t budget) {
+    uint64_t done;
+
+    save_current();
+    if (threaded && hart_count <= HART_THREADS_MAX)
+        done = run_threads(budget);
+    else
+        done = run_coroutines(budget);
+    load_hart(current);
+    RUN_BIT = any_running();
+    return done;
+}
+
+int hart_current(void) {
+    return current;
+}
+
+// Copia el estado de los hart_count harts; el seleccionado vive en los globales
+void hart_export(HartState *out) {
+    for (int i = 0; i < hart_count; i++) {
+        memset(&out[i], 0, sizeof(HartState));
+        out[i].state = i == current ? CURRENT_STATE : harts[i].state;
+        out[i].run_bit = hart_count == 1 ? RUN_BIT : harts[i].run_bit;
+        out[i].count = hart_count == 1 ? INSTRUCTION_COUNT : harts[i].count;
+    }
+}
+
+// Reemplaza todos los harts. Las corrutinas existentes se reusan: el
+// scheduler carga el estado desde harts[] antes de cada turno.
+void hart_import(int n, int cur, const HartState *in) {
+    for (int i = n; i < hart_count; i++) {
+        free(harts[i].stack);
+        harts[i].stack = NULL;
+    }
+    for (int i = 0; i < n; i++) {
+        if (i >= hart_count) memset(&harts[i], 0, sizeof(Hart));
+        harts[i].state = in[i].state;
+        harts[i].run_bit = in[i].run_bit;
+        harts[i].count = in[i].count;
+    }
+    hart_count = n;
+    current = cur;
+    load_hart(cur);
+    if (n > 1) RUN_BIT = any_running();
+}
+
+void hart_dump(FILE *out) {
+    int running = 0;
+    if (hart_count == 1) return;
+    for (int i = 0; i < hart_count; i++) running += harts[i].run_bit;
+    fprintf(out, "Harts             : %d (%d running)\n", hart_count, running);
+    for (int i = 0; i < hart_count && i < HART_DUMP_MAX; i++)
+        fprintf(out, "Hart %d%s PC 0x%08" PRIx64 "  %10" PRIu64 " instructions  %s\n", i, i == current ? "*" : " ",
+                i == current ? CURRENT_STATE.PC : harts[i].state.PC, harts[i].count,
+                harts[i].run_bit ? "running" : "halted");
+}
@@ -0,0 +1,38 @@
+#ifndef HART_H
+#define HART_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "shell.h"
+
+// Varios harts sobre las MEM_REGIONS compartidas. Cada hart tiene su
+// CPU_State y su RUN_BIT; el estado del hart seleccionado es el que ven
+// rdump e input, y los snapshots guardan todos los harts. Por defecto corren como corrutinas en un
+// solo thread; en modo relajado, uno por thread del host.
+#define HART_MAX 4096
+#define HART_THREADS_MAX 64
+
+// Estado de un hart para marcas y snapshots
+typedef struct {
+    CPU_State state;
+    int32_t run_bit;
+    uint32_t reserved;
+    uint64_t count;
+} HartState;
+
+extern int hart_count;
+extern HART_LOCAL int hart_yield;     // pedido de ceder el hart (YIELD, WFE, WFI)
+
+int hart_configure(int n);
+void hart_set_quantum(uint64_t quantum);
+void hart_set_threads(int on);
+int hart_threads_enabled(void);
+int hart_select(int id);
+uint64_t hart_run(uint64_t budget);
+uint64_t hart_clock(void);    // instrucciones totales, tambien dentro de los threads
+void hart_dump(FILE *out);
+int hart_current(void);
+void hart_export(HartState *out);
+void hart_import(int n, int cur, const HartState *in);
+
+#endif
@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include "hotspot.h"
+#include "shell.h"
+
+#define HOT_SLOTS (MEM_TEXT_SIZE / 4)
+#define HOT_LABEL_LEN 64
+#define HOT_TEXT_LEN 64
+
+typedef struct {
+    int line;                   // linea en el .s (0 si no hay mapa)
+    int label;                  // indice en hot_labels o -1
+    char text[HOT_TEXT_LEN];
+} HotSource;
+
+int hotspot_enabled = 0;
+
+static uint64_t *pc_counts = NULL;
+static uint64_t *block_counts = NULL;
+static int new_block = 1;
+
+static HotSource *source = NULL;
+static int source_len = 0;
+static char (*hot_labels)[HOT_LABEL_LEN] = NULL;
+static int hot_nlabels = 0;
+
+// Arma el mapa indice de instruccion -> linea/label a partir del .s:
+// cada linea que no es vacia, comentario, label ni directiva ocupa 4 bytes.
+static int load_source_map(const char *asm_file) {
+    FILE *f = fopen(asm_file, "r");
+    if (!f) return -1;
+    free(source);
+    free(hot_labels);
+    source = calloc(HOT_SLOTS, sizeof(*source));
+    hot_labels = NULL;
+    source_len = hot_nlabels = 0;
+
+    char line[256];
+    int lineno = 0, cur_label = -1;
+    while (fgets(line, sizeof(line), f) && source_len < HOT_SLOTS) {
+        lineno++;
+        char *p = line;
+        char *c = strstr(p, "//");
+        if (c) *c = '\0';
+        while (isspace((unsigned char)*p)) p++;
+        char *colon = strchr(p, ':');
+        if (colon) {
+            *colon = '\0';
+            hot_labels = realloc(hot_labels, (hot_nlabels + 1) * sizeof(*hot_labels));
+            snprintf(hot_labels[hot_nlabels], HOT_LABEL_LEN, "%.*s", HOT_LABEL_LEN - 1, p);
+            cur_label = hot_nlabels++;
+            p = colon + 1;
+            while (isspace((unsigned char)*p)) p++;
+        }
+        if (*p == '\0' || *p == '.' || *p == ';' || *p == '@') continue;
+        char *end = p + strlen(p);
+        while (end > p && isspace((unsigned char)end[-1])) *--end = '\0';
+        source[source_len].line = lineno;
+        source[source_len].label = cur_label;
+        snprintf(source[source_len].text, HOT_TEXT_LEN, "%.*s", HOT_TEXT_LEN - 1, p);
+        source_len++;
+    }
+    fclose(f);
+    return 0;
+}
+
+int hotspot_enable(const char *asm_file) {
+    if (!pc_counts) {
+        pc_counts = calloc(HOT_SLOTS, sizeof(uint64_t));
+        block_counts = calloc(HOT_SLOTS, sizeof(uint64_t));
+    }
+    new_block = 1;
+    hotspot_enabled = 1;
+    if (asm_file && load_source_map(asm_file) != 0) return -1;
+    return 0;
+}
+
+void hotspot_disable(void) {
+    hotspot_enabled = 0;
+}
+
+void hotspot_record(uint64_t pc, int ends_block) {
+    uint64_t idx = (pc - MEM_TEXT_START) >> 2;
+    if (idx >= HOT_SLOTS) return;
+    pc_counts[idx]++;
+    block_counts[idx] += new_block;
+    new_block = ends_block;
+}
+
+static const char *label_of(uint64_t idx) {
+    if (idx < source_len && source[idx].label >= 0) return hot_labels[source[idx].label];
+    return "_start";
+}
+
+static uint64_t *sort_keys;
+
+static int by_count_desc(const void *a, const void *b) {
+    uint64_t ca = sort_keys[*(const uint32_t *)a], cb = sort_keys[*(const uint32_t *)b];
+    return (ca < cb) - (ca > cb);
+}
+
+// Indices con cuenta distinta de cero, ordenados de mayor a menor
+static uint32_t *sorted_nonzero(uint64_t *counts, int *n, uint64_t *total) {
+    uint32_t *idx = malloc(HOT_SLOTS * sizeof(uint32_t));
+    *n = 0;
+    *total = 0;
+    for (uint32_t i = 0; i < HOT_SLOTS; i++) {
+        if (!counts[i]) continue;
+        idx[(*n)++] = i;
+        *total += counts[i];
+    }
+    sort_keys = counts;
+    qsort(idx, *n, sizeof(uint32_t), by_count_desc);
+    return idx;
+}
+
+static void print_entry(FILE *out, uint32_t i, uint64_t count, uint64_t total) {
+    fprintf(out, "  0x%08" PRIx64 " %14" PRIu64 " %6.2f%%", (uint64_t)MEM_TEXT_START + 4 * i,
+            count, 100.0 * count / total);
+    if (i < source_len)
+        fprintf(out, "  line %-5d %-16s %s", source[i].line, label_of(i), source[i].text);
+    fprintf(out, "\n");
+}
+
+// Escribe <prefix>.txt (reporte ordenado) y <prefix>.folded (formato de
+// flamegraph.pl: label;pc cuenta) y muestra los top PCs por pantalla.
+int hotspot_report(const char *prefix, int top) {
+    if (!pc_counts) return -1;
+    char path[512];
+    int npc, nblk;
+    uint64_t total, blk_total;
+    uint32_t *pcs = sorted_nonzero(pc_counts, &npc, &total);
+    uint32_t *blks = sorted_nonzero(block_counts, &nblk, &blk_total);
+
+    printf("\nHot spots (%" PRIu64 " instructions, %" PRIu64 " blocks):\n", total, blk_total);
+    printf("-------------------------------------\n");
+    for (int k = 0; k < npc && k < top; k++)
+        print_entry(stdout, pcs[k], pc_counts[pcs[k]], total);
+    printf("\n");
+
+    if (prefix) {
+        snprintf(path, sizeof(path), "%s.txt", prefix);
+        FILE *out = fopen(path, "w");
+        if (!out) goto fail;
+        fprintf(out, "# per-PC counts (%" PRIu64 " instructions)\n", total);
+        for (int k = 0; k < npc; k++)
+            print_entry(out, pcs[k], pc_counts[pcs[k]], total);
+        fprintf(out, "\n# basic block entries (%" PRIu64 " blocks)\n", blk_total);
+        for (int k = 0; k < nblk; k++)
+            print_entry(out, blks[k], block_counts[blks[k]], blk_total);
+        fclose(out);
+
+        snprintf(path, sizeof(path), "%s.folded", prefix);
+        out = fopen(path, "w");
+        if (!out) goto fail;
+        for (int k = 0; k < npc; k++) {
+            uint32_t i = pcs[k];
+            fprintf(out, "guest;%s;0x%08" PRIx64, label_of(i), (uint64_t)MEM_TEXT_START + 4 * i);
+            if (i < source_len) fprintf(out, " line %d", source[i].line);
+            fprintf(out, " %" PRIu64 "\n", pc_counts[i]);
+        }
+        fclose(out);
+    }
+    free(pcs);
+    free(blks);
+    return 0;
+
+fail:
+    free(pcs);
+    free(blks);
+    return -1;
+}
@@ -0,0 +1,15 @@
+#ifndef HOTSPOT_H
+#define HOTSPOT_H
+
+#include <stdint.h>
+
+// Perfil de hot spots del programa guest: cuenta ejecuciones por PC y por
+// bloque basico en arreglos planos de MEM_TEXT_SIZE/4 entradas.
+extern int hotspot_enabled;
+
+int hotspot_enable(const char *asm_file);
+void hotspot_disable(void);
+void hotspot_record(uint64_t pc, int ends_block);
+int hotspot_report(const char *prefix, int top);
+
+#endif
@@ -0,0 +1,270 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "ooo.h"
+#include "shell.h"
+
+#define OOO_BATCH 4096
+#define OOO_MAX_WIDTH 16
+#define OOO_MAX_WINDOW 1024
+#define ISSUE_RING 8192         // ciclos de issue en vuelo, potencia de 2
+#define STQ_SLOTS 256           // ultimas stores por direccion (forwarding)
+#define HIST_BUCKETS 16
+#define PC_SLOTS (MEM_TEXT_SIZE / 4)
+
+enum { DSP_ROB, DSP_RS, DSP_LSQ, DSP_FETCH, DSP_NKINDS };
+enum { WAIT_ALU, WAIT_MUL, WAIT_LOAD, WAIT_STORE, WAIT_NKINDS };
+
+static const char *dispatch_names[DSP_NKINDS] = { "ROB full", "RS full", "LSQ full", "taken branch" };
+static const char *wait_names[WAIT_NKINDS] = { "ALU", "MUL", "load", "store" };
+
+static uint32_t params[OOO_NPARAMS] = { 4, 128, 32, 32 };
+static const uint32_t param_max[OOO_NPARAMS] = { OOO_MAX_WIDTH, OOO_MAX_WINDOW, OOO_MAX_WINDOW, OOO_MAX_WINDOW };
+static const uint32_t latency[CLS_SYS + 1] = {
+    [CLS_ALU] = 1, [CLS_MUL] = 3, [CLS_LOAD] = 4, [CLS_STORE] = 1,
+    [CLS_BRANCH] = 1, [CLS_COND_BRANCH] = 1, [CLS_SYS] = 1,
+};
+
+static int enabled = 0;
+static RetireInfo batch[OOO_BATCH];
+static int batch_len = 0;
+
+// Estado del modelo; los anillos se indexan por numero de secuencia
+static uint64_t seq, mem_seq;
+static uint64_t dispatch_at[OOO_MAX_WIDTH], commit_at[OOO_MAX_WIDTH];
+static uint64_t rob_commit[OOO_MAX_WINDOW], lsq_commit[OOO_MAX_WINDOW];
+static uint64_t rs_heap[OOO_MAX_WINDOW];    // ciclos de issue de las RS ocupadas
+static uint32_t rs_len;
+static uint64_t issue_tag[ISSUE_RING];
+static uint32_t issue_used[ISSUE_RING];
+static uint64_t fetch_ready, last_dispatch, last_commit;
+static uint64_t ready[RETIRE_SLOTS];        // tabla de renombrado: ciclo en que el valor esta listo
+static uint8_t producer[RETIRE_SLOTS];
+static struct { uint64_t addr, ready, commit; } stq[STQ_SLOTS];
+static uint64_t rob_head;                   // mas vieja sin commit al despachar
+
+static uint64_t instructions, cycles;
+static uint64_t dispatch_stalls[DSP_NKINDS], operand_waits[WAIT_NKINDS], forwarded_loads;
+static uint64_t occupancy[HIST_BUCKETS];
+static uint64_t *head_stalls = NULL;        // ciclos con la instruccion en la cabeza del ROB sin completar
+
+static void rs_push(uint64_t t) {
+    uint32_t i = rs_len++;
+    while (i > 0 && rs_heap[(i - 1) / 2] > t) {
+        rs_heap[i] = rs_heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    rs_heap[i] = t;
+}
+
+static void rs_pop(void) {
+    uint64_t t = rs_heap[--rs_len];
+    uint32_t i = 0;
+    for (;;) {
+        uint32_t c = 2 * i + 1;
+        if (c >= rs_len) break;
+        if (c + 1 < rs_len && rs_heap[c + 1] < rs_heap[c]) c++;
+        if (rs_heap[c] >= t) break;
+        rs_heap[i] = rs_heap[c];
+        i = c;
+    }
+    rs_heap[i] = t;
+}
+
+// Primer ciclo >= t con un puerto de issue libre
+static uint64_t issue_slot(uint64_t t) {
+    for (;; t++) {
+        uint32_t k = t & (ISSUE_RING - 1);
+        if (issue_tag[k] != t) {
+            issue_tag[k] = t;
+            issue_used[k] = 0;
+        }
+        if (issue_used[k] < params[OOO_WIDTH]) {
+            issue_used[k]++;
+            return t;
+        }
+    }
+}
+
+static void stall(uint64_t *t, uint64_t bound, uint64_t *counter) {
+    if (bound > *t) {
+        *counter += bound - *t;
+        *t = bound;
+    }
+}
+
+static void simulate(const RetireInfo *r) {
+    uint32_t width = params[OOO_WIDTH], rob = params[OOO_ROB];
+    int is_mem = r->cls == CLS_LOAD || r->cls == CLS_STORE;
+
+    // Dispatch en orden: ancho de fetch, corte de fetch por salto tomado y
+    // espacio en ROB, RS y LSQ
+    uint64_t d = last_dispatch;
+    if (seq >= width && dispatch_at[seq % width] + 1 > d) d = dispatch_at[seq % width] + 1;
+    stall(&d, fetch_ready, &dispatch_stalls[DSP_FETCH]);
+    if (seq >= rob) stall(&d, rob_commit[seq % rob], &dispatch_stalls[DSP_ROB]);
+    if (is_mem && mem_seq >= params[OOO_LSQ])
+        stall(&d, lsq_commit[mem_seq % params[OOO_LSQ]], &dispatch_stalls[DSP_LSQ]);
+    while (rs_len && rs_heap[0] <= d) rs_pop();
+    if (rs_len == params[OOO_RS]) {
+        stall(&d, rs_heap[0], &dispatch_stalls[DSP_RS]);
+        while (rs_len && rs_heap[0] <= d) rs_pop();
+    }
+
+    // Ocupacion del ROB durante los ciclos desde el dispatch anterior
+    while (rob_head < seq && rob_commit[rob_head % rob] <= d) rob_head++;
+    if (seq) occupancy[(seq - rob_head) * HIST_BUCKETS / (rob + 1)] += d - last_dispatch;
+
+    // Issue cuando los operandos renombrados estan listos
+    uint64_t op_ready = d + 1;
+    int waited_on = -1;
+    for (int i = 0; i < r->nsrc; i++) {
+        if (ready[r->src[i]] > op_ready) {
+            op_ready = ready[r->src[i]];
+            waited_on = producer[r->src[i]];
+        }
+    }
+    // Forwarding solo desde una store que todavia no hizo commit; despues
+    // el load lee de memoria con la latencia normal
+    uint32_t lat = latency[r->cls];
+    uint32_t k = (r->addr >> 3) % STQ_SLOTS;
+    int in_stq = r->cls == CLS_LOAD && stq[k].addr == r->addr && stq[k].commit > op_ready;
+    if (in_stq && stq[k].ready > op_ready) {
+        op_ready = stq[k].ready;
+        waited_on = WAIT_STORE;
+    }
+    if (waited_on >= 0) operand_waits[waited_on] += op_ready - (d + 1);
+    uint64_t issue = issue_slot(op_ready);
+    if (in_stq && stq[k].commit > issue) {
+        lat = 1;
+        forwarded_loads++;
+    }
+    uint64_t done = issue + lat;
+    rs_push(issue);
+
+    for (int i = 0; i < r->ndst; i++) {
+        ready[r->dst[i]] = done;
+        producer[r->dst[i]] = r->cls == CLS_MUL ? WAIT_MUL : r->cls == CLS_LOAD ? WAIT_LOAD : WAIT_ALU;
+    }
+
+    // Commit en orden, hasta width por ciclo
+    uint64_t c = last_commit;
+    if (seq >= width && commit_at[seq % width] + 1 > c) c = commit_at[seq % width] + 1;
+    if (done + 1 > c) {
+        uint64_t idx = (r->pc - MEM_TEXT_START) >> 2;
+        if (idx < PC_SLOTS) head_stalls[idx] += done + 1 - c;
+        c = done + 1;
+    }
+
+    dispatch_at[seq % width] = d;
+    commit_at[seq % width] = c;
+    rob_commit[seq % rob] = c;
+    if (is_mem) lsq_commit[mem_seq++ % params[OOO_LSQ]] = c;
+    if (r->cls == CLS_STORE) {
+        stq[k].addr = r->addr;
+        stq[k].ready = done;
+        stq[k].commit = c;
+    }
+    if (r->taken) fetch_ready = d + 1;
+    last_dispatch = d;
+    last_commit = c;
+    seq++;
+    instructions++;
+    cycles = c;
+}
+
+static void flush_batch(void) {
+    for (int i = 0; i < batch_len; i++) simulate(&batch[i]);
+    batch_len = 0;
+}
+
+void ooo_retire(const RetireInfo *r) {
+    batch[batch_len++] = *r;
+    if (batch_len == OOO_BATCH) flush_batch();
+}
+
+void ooo_reset(void) {
+    batch_len = 0;
+    seq = mem_seq = rs_len = 0;
+    fetch_ready = last_dispatch = last_commit = rob_head = 0;
+    instructions = cycles = forwarded_loads = 0;
+    memset(issue_tag, 0xFF, sizeof(issue_tag));
+    memset(ready, 0, sizeof(ready));
+    memset(stq, 0xFF, sizeof(stq));
+    memset(dispatch_stalls, 0, sizeof(dispatch_stalls));
+    memset(operand_waits, 0, sizeof(operand_waits));
+    memset(occupancy, 0, sizeof(occupancy));
+    if (head_stalls) memset(head_stalls, 0, PC_SLOTS * sizeof(uint64_t));
+}
+
+void ooo_enable(void) {
+    if (!head_stalls) head_stalls = calloc(PC_SLOTS, sizeof(uint64_t));
+    ooo_reset();
+    enabled = 1;
+    retire_consumers |= RETIRE_OOO;
+}
+
+void ooo_disable(void) {
+    flush_batch();
+    retire_consumers &= ~RETIRE_OOO;
+}
+
+// Cambiar la configuracion reinicia el modelo; devuelve -1 si el valor no es valido
+int ooo_set_param(int param, uint32_t value) {
+    if (param < 0 || param >= OOO_NPARAMS || value == 0 || value > param_max[param]) return -1;
+    flush_batch();
+    params[param] = value;
+    ooo_reset();
+    return 0;
+}
+
+static int by_stalls_desc(const void *a, const void *b) {
+    uint64_t sa = head_stalls[*(const uint32_t *)a], sb = head_stalls[*(const uint32_t *)b];
+    return (sa < sb) - (sa > sb);
+}
+
+void ooo_report(FILE *out, int top) {
+    uint32_t *idx, n = 0;
+    uint64_t total = 0;
+
+    if (!enabled) {
+        fprintf(out, "Out-of-order model disabled, use 'ooo on'\n\n");
+        return;
+    }
+    flush_batch();
+    fprintf(out, "\nOut-of-order core (width %u, ROB %u, RS %u, LSQ %u):\n", params[OOO_WIDTH],
+            params[OOO_ROB], params[OOO_RS], params[OOO_LSQ]);
+    fprintf(out, "-------------------------------------\n");
+    fprintf(out, "Instructions      : %" PRIu64 "\n", instructions);
+    fprintf(out, "Cycles            : %" PRIu64 "\n", cycles);
+    fprintf(out, "IPC               : %.3f\n", cycles ? (double)instructions / cycles : 0.0);
+    fprintf(out, "Dispatch stalls   :");
+    for (int k = 0; k < DSP_NKINDS; k++)
+        fprintf(out, " %s %" PRIu64 "%s", dispatch_names[k], dispatch_stalls[k], k + 1 < DSP_NKINDS ? "," : "\n");
+    fprintf(out, "Operand waits     :");
+    for (int k = 0; k < WAIT_NKINDS; k++)
+        fprintf(out, " %s %" PRIu64 "%s", wait_names[k], operand_waits[k], k + 1 < WAIT_NKINDS ? "," : "\n");
+    fprintf(out, "Forwarded loads   : %" PRIu64 "\n", forwarded_loads);
+
+    for (int b = 0; b < HIST_BUCKETS; b++) total += occupancy[b];
+    fprintf(out, "\nROB occupancy (cycles):\n");
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        uint32_t lo = b * (params[OOO_ROB] + 1) / HIST_BUCKETS;
+        uint32_t hi = (b + 1) * (params[OOO_ROB] + 1) / HIST_BUCKETS;
+        if (hi <= lo) continue;
+        fprintf(out, "  %4u-%-4u %12" PRIu64 "  %6.2f%%\n", lo, hi - 1, occupancy[b],
+                total ? 100.0 * occupancy[b] / total : 0.0);
+    }
+
+    idx = malloc(PC_SLOTS * sizeof(uint32_t));
+    for (uint32_t i = 0; i < PC_SLOTS; i++)
+        if (head_stalls[i]) idx[n++] = i;
+    qsort(idx, n, sizeof(uint32_t), by_stalls_desc);
+    fprintf(out, "\nPCs stalling commit at the ROB head:\n");
+    for (uint32_t k = 0; k < n && k < top; k++)
+        fprintf(out, "  0x%08" PRIx64 "  stalls %12" PRIu64 "  %6.2f%%\n", (uint64_t)MEM_TEXT_START + 4 * idx[k],
+                head_stalls[idx[k]], cycles ? 100.0 * head_stalls[idx[k]] / cycles : 0.0);
+    fprintf(out, "\n");
+    free(idx);
+}
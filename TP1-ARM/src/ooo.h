@@ -0,0 +1,20 @@
+#ifndef OOO_H
+#define OOO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "retire.h"
+
+// Modelo de timing fuera de orden (fetch, renombrado, RS, ROB y LSQ) guiado
+// por el flujo de instrucciones retiradas. Las instrucciones se acumulan en
+// lotes y se procesan fuera del camino funcional.
+enum { OOO_WIDTH, OOO_ROB, OOO_RS, OOO_LSQ, OOO_NPARAMS };
+
+void ooo_enable(void);
+void ooo_disable(void);
+void ooo_reset(void);
+int ooo_set_param(int param, uint32_t value);
+void ooo_retire(const RetireInfo *r);
+void ooo_report(FILE *out, int top);
+
+#endif
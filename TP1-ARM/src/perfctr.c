@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "perfctr.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#define CACHE_MISS(cache) ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | \
+                           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+typedef struct {
+    const char *name;
+    uint32_t type;
+    uint64_t config;
+    int fd;
+    uint64_t value;             // ultimo valor medido, escalado si hubo multiplexado
+} PerfCounter;
+
+#ifdef __linux__
+static PerfCounter counters[] = {
+    {"instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, -1, 0},
+    {"cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1, 0},
+    {"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, -1, 0},
+    {"L1d-misses",    PERF_TYPE_HW_CACHE, CACHE_MISS(PERF_COUNT_HW_CACHE_L1D), -1, 0},
+    {"LLC-misses",    PERF_TYPE_HW_CACHE, CACHE_MISS(PERF_COUNT_HW_CACHE_LL), -1, 0},
+    {"iTLB-misses",   PERF_TYPE_HW_CACHE, CACHE_MISS(PERF_COUNT_HW_CACHE_ITLB), -1, 0},
+    {"task-clock-ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, -1, 0},
+};
+#define NCOUNTERS (sizeof(counters) / sizeof(counters[0]))
+#endif
+
+int perfctr_enabled = 0;
+static uint64_t measured_instructions = 0;
+static int measured = 0;
+
+// Abre los contadores disponibles; devuelve cuantos se pudieron abrir
+int perfctr_enable(void) {
+    int opened = 0;
+#ifdef __linux__
+    for (int i = 0; i < NCOUNTERS; i++) {
+        if (counters[i].fd < 0) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = counters[i].type;
+            attr.config = counters[i].config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            counters[i].fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+        opened += counters[i].fd >= 0;
+    }
+#endif
+    perfctr_enabled = opened > 0;
+    return opened;
+}
+
+void perfctr_disable(void) {
+#ifdef __linux__
+    for (int i = 0; i < NCOUNTERS; i++) {
+        if (counters[i].fd >= 0) close(counters[i].fd);
+        counters[i].fd = -1;
+    }
+#endif
+    perfctr_enabled = 0;
+}
+
+void perfctr_start(void) {
+#ifdef __linux__
+    for (int i = 0; i < NCOUNTERS; i++) {
+        if (counters[i].fd < 0) continue;
+        ioctl(counters[i].fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counters[i].fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+void perfctr_stop(uint64_t guest_instructions) {
+#ifdef __linux__
+    for (int i = 0; i < NCOUNTERS; i++) {
+        uint64_t buf[3];
+        if (counters[i].fd < 0) continue;
+        ioctl(counters[i].fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counters[i].fd, buf, sizeof(buf)) != sizeof(buf)) {
+            counters[i].value = 0;
+            continue;
+        }
+        // buf = {valor, tiempo habilitado, tiempo corriendo}
+        counters[i].value = buf[2] ? (uint64_t)((double)buf[0] * buf[1] / buf[2]) : buf[0];
+    }
+#endif
+    measured_instructions = guest_instructions;
+    measured = 1;
+}
+
+void perfctr_report(FILE *out) {
+    if (!measured) {
+        fprintf(out, "No host counter data, use 'perfstat on' before go/run\n\n");
+        return;
+    }
+    fprintf(out, "\nHost counters (%" PRIu64 " guest instructions):\n", measured_instructions);
+    fprintf(out, "-------------------------------------\n");
+#ifdef __linux__
+    for (int i = 0; i < NCOUNTERS; i++) {
+        if (counters[i].fd < 0) {
+            fprintf(out, "%-14s %16s\n", counters[i].name, "n/a");
+            continue;
+        }
+        fprintf(out, "%-14s %16" PRIu64 " %10.3f/guest instr\n", counters[i].name, counters[i].value,
+                measured_instructions ? (double)counters[i].value / measured_instructions : 0.0);
+    }
+#endif
+    fprintf(out, "\n");
+}
@@ -0,0 +1,17 @@
+#ifndef PERFCTR_H
+#define PERFCTR_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Contadores de hardware del host (perf_event_open) alrededor de go/run,
+// normalizados por instruccion simulada.
+extern int perfctr_enabled;
+
+int perfctr_enable(void);
+void perfctr_disable(void);
+void perfctr_start(void);
+void perfctr_stop(uint64_t guest_instructions);
+void perfctr_report(FILE *out);
+
+#endif
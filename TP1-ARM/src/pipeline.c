@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "pipeline.h"
+
+static const char *stall_names[STALL_NKINDS] = { "RAW", "load-use", "MUL busy", "branch flush" };
+
+static int forwarding = 1;
+static uint32_t mul_latency = 3;
+static uint32_t branch_penalty = 2;
+
+// Ciclos absolutos: la primera instruccion esta en EX en el ciclo 2
+static uint64_t last_ex;                // ciclo de EX de la instruccion anterior
+static uint64_t ex_free;                // primer ciclo en que EX esta libre
+static uint64_t redirect;               // primer EX posible tras un salto tomado
+static uint64_t ready[RETIRE_SLOTS];    // primer EX que puede usar cada registro
+static uint8_t from_load[RETIRE_SLOTS];
+static uint64_t instructions, stalls[STALL_NKINDS];
+
+void pipeline_reset(void) {
+    last_ex = 1;
+    ex_free = redirect = 2;
+    memset(ready, 0, sizeof(ready));
+    memset(from_load, 0, sizeof(from_load));
+    memset(stalls, 0, sizeof(stalls));
+    instructions = 0;
+}
+
+void pipeline_enable(void) {
+    pipeline_reset();
+    retire_consumers |= RETIRE_PIPELINE;
+}
+
+void pipeline_disable(void) {
+    retire_consumers &= ~RETIRE_PIPELINE;
+}
+
+void pipeline_set_forwarding(int on) {
+    forwarding = on;
+}
+
+void pipeline_set_mul_latency(uint32_t cycles) {
+    mul_latency = cycles ? cycles : 1;
+}
+
+void pipeline_set_branch_penalty(uint32_t cycles) {
+    branch_penalty = cycles;
+}
+
+void pipeline_retire(const RetireInfo *r) {
+    uint64_t ex = last_ex + 1;
+    int cause = -1;
+
+    // Riesgos estructurales (MUL ocupa EX) y de control (flush)
+    if (ex_free > ex) { ex = ex_free; cause = STALL_MUL; }
+    if (redirect > ex) { ex = redirect; cause = STALL_BRANCH; }
+    // Riesgos RAW
+    for (int i = 0; i < r->nsrc; i++) {
+        uint8_t s = r->src[i];
+        if (ready[s] > ex) {
+            ex = ready[s];
+            cause = from_load[s] && forwarding ? STALL_LOAD_USE : STALL_RAW;
+        }
+    }
+    if (cause >= 0) stalls[cause] += ex - (last_ex + 1);
+
+    uint32_t busy = r->cls == CLS_MUL ? mul_latency : 1;
+    uint64_t result_ex = ex + busy - 1;          // ultimo ciclo en EX
+    for (int i = 0; i < r->ndst; i++) {
+        uint8_t d = r->dst[i];
+        if (!forwarding)
+            ready[d] = result_ex + 3;            // WB escribe, ID lee en el mismo ciclo
+        else
+            ready[d] = result_ex + (r->cls == CLS_LOAD ? 2 : 1);
+        from_load[d] = r->cls == CLS_LOAD;
+    }
+    ex_free = result_ex + 1;
+    // Se predice no tomado; el salto se resuelve en EX
+    if (r->taken) redirect = ex + 1 + branch_penalty;
+    last_ex = ex;
+    instructions++;
+}
+
+// Imprime ciclos, CPI y el desglose de stalls; devuelve 0 si el modelo esta apagado
+int pipeline_dump(FILE *out) {
+    if (!(retire_consumers & RETIRE_PIPELINE)) return 0;
+    uint64_t cycles = instructions ? last_ex + 3 : 0;
+    fprintf(out, "Pipeline Cycles   : %" PRIu64 " (%s forwarding, MUL %u, branch %u)\n", cycles,
+            forwarding ? "with" : "no", mul_latency, branch_penalty);
+    fprintf(out, "Pipeline CPI      : %.3f\n", instructions ? (double)cycles / instructions : 0.0);
+    fprintf(out, "Stall cycles      :");
+    for (int k = 0; k < STALL_NKINDS; k++)
+        fprintf(out, " %s %" PRIu64 "%s", stall_names[k], stalls[k], k + 1 < STALL_NKINDS ? "," : "\n");
+    return 1;
+}
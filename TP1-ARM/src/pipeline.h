@@ -0,0 +1,21 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "retire.h"
+
+// Modelo de timing de un pipeline en orden IF/ID/EX/MEM/WB sobre el flujo
+// de instrucciones retiradas; no cambia la ejecucion funcional.
+enum { STALL_RAW, STALL_LOAD_USE, STALL_MUL, STALL_BRANCH, STALL_NKINDS };
+
+void pipeline_enable(void);
+void pipeline_disable(void);
+void pipeline_reset(void);
+void pipeline_set_forwarding(int on);
+void pipeline_set_mul_latency(uint32_t cycles);
+void pipeline_set_branch_penalty(uint32_t cycles);
+void pipeline_retire(const RetireInfo *r);
+int pipeline_dump(FILE *out);
+
+#endif
@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include "prof.h"
+#include "handlers.h"
+
+#ifdef SIM_PROF
+
+uint64_t prof_phase[PROF_NPHASES];
+uint64_t prof_handler_ticks[MAX_OPCODES];
+uint64_t prof_handler_calls[MAX_OPCODES];
+
+static const char *phase_names[PROF_NPHASES] = { "fetch", "decode", "execute", "commit" };
+
+static double pct(uint64_t part, uint64_t total) {
+    return total ? 100.0 * part / total : 0.0;
+}
+
+void prof_report(FILE *out) {
+    uint64_t total = 0, calls = 0;
+    for (int i = 0; i < PROF_NPHASES; i++) total += prof_phase[i];
+    for (int i = 0; i < OPCODE_COUNT; i++) calls += prof_handler_calls[i];
+
+    fprintf(out, "\nHost time per phase (%" PRIu64 " instructions):\n", calls);
+    fprintf(out, "-------------------------------------\n");
+    for (int i = 0; i < PROF_NPHASES; i++)
+        fprintf(out, "%-10s %14" PRIu64 " ticks %6.2f%% %8.1f/instr\n", phase_names[i],
+                prof_phase[i], pct(prof_phase[i], total), calls ? (double)prof_phase[i] / calls : 0.0);
+
+    fprintf(out, "\nHost time per handler:\n");
+    fprintf(out, "-------------------------------------\n");
+    for (int i = 0; i < OPCODE_COUNT; i++) {
+        if (!prof_handler_calls[i]) continue;
+        fprintf(out, "%-12s %12" PRIu64 " calls %14" PRIu64 " ticks %8.1f/call\n", OPCODE_TABLE[i].name,
+                prof_handler_calls[i], prof_handler_ticks[i],
+                (double)prof_handler_ticks[i] / prof_handler_calls[i]);
+    }
+    fprintf(out, "\n");
+}
+
+#else
+
+void prof_report(FILE *out) {
+    fprintf(out, "Profiling not compiled in, build with 'make sim_prof'\n\n");
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef PROF_H
+#define PROF_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Fases del ciclo que se miden en el build instrumentado (make sim_prof)
+enum { PROF_FETCH, PROF_DECODE, PROF_EXECUTE, PROF_COMMIT, PROF_NPHASES };
+
+#ifdef SIM_PROF
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t prof_now(void) { return __rdtsc(); }
+#else
+#include <time.h>
+static inline uint64_t prof_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#endif
+
+extern uint64_t prof_phase[PROF_NPHASES];
+extern uint64_t prof_handler_ticks[];
+extern uint64_t prof_handler_calls[];
+
+#define PROF_START(t) uint64_t t = prof_now()
+#define PROF_LAP(t, phase) do { uint64_t _now = prof_now(); \
+        prof_phase[phase] += _now - (t); (t) = _now; } while (0)
+#define PROF_LAP_HANDLER(t, id) do { uint64_t _now = prof_now(); \
+        prof_phase[PROF_EXECUTE] += _now - (t); \
+        prof_handler_ticks[id] += _now - (t); \
+        prof_handler_calls[id]++; (t) = _now; } while (0)
+#define PROF_HALT() prof_report(stdout)
+
+#else
+
+#define PROF_START(t)
+#define PROF_LAP(t, phase)
+#define PROF_LAP_HANDLER(t, id)
+#define PROF_HALT()
+
+#endif
+
+void prof_report(FILE *out);
+
+#endif
@@ -0,0 +1,60 @@
+#include <stdint.h>
+#include "retire.h"
+#include "decode.h"
+#include "pipeline.h"
+#include "ooo.h"
+#include "trace.h"
+
+int retire_consumers = 0;
+
+static void add_src(RetireInfo *r, uint32_t reg, int sp) {
+    if (reg == 31 && !sp) return;           // XZR no genera dependencias
+    r->src[r->nsrc++] = sp ? SP_R(reg) : reg;
+}
+
+static void add_dst(RetireInfo *r, uint32_t reg, int sp) {
+    if (reg == 31 && !sp) return;
+    r->dst[r->ndst++] = sp ? SP_R(reg) : reg;
+}
+
+// Los modos pre/post-indexados escriben la base: bit 23 en los pares,
+// bit 10 en LDUR/STUR y variantes
+static int writes_back(uint32_t instr) {
+    if (((instr >> 27) & 7) == 5) return (instr >> 23) & 1;
+    return (instr >> 10) & 1;
+}
+
+// Arma el RetireInfo de la instruccion recien ejecutada y lo pasa a los
+// consumidores habilitados. Se llama despues del handler, con NEXT_STATE listo.
+void retire_instruction(const InstructionEntry *entry, uint32_t instr) {
+    RetireInfo r;
+    int ops = entry->ops;
+
+    r.pc = CURRENT_STATE.PC;
+    r.instr = instr;
+    r.id = entry - OPCODE_TABLE;
+    r.cls = entry->cls;
+    r.taken = NEXT_STATE.PC != CURRENT_STATE.PC + 4;
+    if (entry->cls == CLS_LOAD || entry->cls == CLS_STORE) {
+        r.addr = mem_last_addr;
+        r.data = mem_last_value;
+    } else {
+        r.addr = r.data = 0;
+    }
+    r.nsrc = r.ndst = 0;
+
+    if (ops & OP_RN) add_src(&r, (instr >> 5) & 0x1F, ops & OP_RN_SP);
+    if (ops & OP_RM) add_src(&r, (instr >> 16) & 0x1F, 0);
+    if (ops & OP_RT) add_src(&r, instr & 0x1F, 0);
+    if (ops & OP_RT2) add_src(&r, (instr >> 10) & 0x1F, 0);
+    if (ops & OP_FLAGS_R) r.src[r.nsrc++] = REG_FLAGS;
+    if (ops & OP_RD) add_dst(&r, instr & 0x1F, ops & OP_RD_SP);
+    if (ops & OP_RM_W) add_dst(&r, (instr >> 16) & 0x1F, 0);
+    if (ops & OP_RT2_W) add_dst(&r, (instr >> 10) & 0x1F, 0);
+    if ((ops & OP_RN_WB) && writes_back(instr)) add_dst(&r, (instr >> 5) & 0x1F, 1);
+    if (ops & OP_FLAGS_W) r.dst[r.ndst++] = REG_FLAGS;
+
+    if (retire_consumers & RETIRE_PIPELINE) pipeline_retire(&r);
+    if (retire_consumers & RETIRE_OOO) ooo_retire(&r);
+    if (retire_consumers & RETIRE_TRACE) trace_retire(&r);
+}
@@ -0,0 +1,36 @@
+#ifndef RETIRE_H
+#define RETIRE_H
+
+#include <stdint.h>
+#include "shell.h"
+#include "handlers.h"
+
+// Flags como un registro mas, para seguir dependencias en los modelos de timing
+#define REG_FLAGS ARM_REG_SLOTS
+#define RETIRE_SLOTS (ARM_REG_SLOTS + 1)
+
+#define RETIRE_MAX_SRC 4
+#define RETIRE_MAX_DST 3
+
+// Instruccion retirada: lo que consumen los modelos de timing y las trazas
+typedef struct {
+    uint64_t pc;
+    uint32_t instr;
+    int id;                     // indice en OPCODE_TABLE
+    InstrClass cls;
+    int taken;                  // el PC siguiente no es pc + 4
+    uint64_t addr;              // direccion accedida por loads/stores
+    uint64_t data;              // valor leido o escrito
+    int nsrc, ndst;
+    uint8_t src[RETIRE_MAX_SRC];
+    uint8_t dst[RETIRE_MAX_DST];
+} RetireInfo;
+
+// Consumidores activos del flujo de instrucciones retiradas
+enum { RETIRE_PIPELINE = 1 << 0, RETIRE_OOO = 1 << 1, RETIRE_TRACE = 1 << 2 };
+
+extern int retire_consumers;
+
+void retire_instruction(const InstructionEntry *entry, uint32_t instr);
+
+#endif
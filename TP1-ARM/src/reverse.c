@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "reverse.h"
+#include "shell.h"
+#include "syscall.h"
+#include "hart.h"
+
+#define CHECKPOINT_INTERVAL 10000
+
+typedef struct {
+    CPU_State state;
+    uint64_t count;             // INSTRUCTION_COUNT del checkpoint
+    int run_bit;
+    uint64_t brk, mmap_top;     // heap del guest, lo mueven brk y mmap
+    size_t log_len;             // largo del undo log al tomarlo
+} Checkpoint;
+
+typedef struct {
+    uint64_t address;
+    uint32_t old_value;
+} UndoEntry;
+
+int reverse_enabled = 0;
+
+static Checkpoint *checkpoints = NULL;
+static size_t ncheckpoints, checkpoints_cap;
+static UndoEntry *undo_log = NULL;
+static size_t log_len, log_cap;
+static int undoing = 0;
+
+static void take_checkpoint(void) {
+    if (ncheckpoints == checkpoints_cap) {
+        checkpoints_cap = checkpoints_cap ? 2 * checkpoints_cap : 64;
+        checkpoints = realloc(checkpoints, checkpoints_cap * sizeof(Checkpoint));
+    }
+    Checkpoint *c = &checkpoints[ncheckpoints++];
+    c->state = CURRENT_STATE;
+    c->count = INSTRUCTION_COUNT;
+    c->run_bit = RUN_BIT;
+    c->brk = guest_brk;
+    c->mmap_top = guest_mmap_top;
+    c->log_len = log_len;
+}
+
+// Descarta la historia y empieza a grabar desde el estado actual. Los
+// checkpoints guardan un solo CPU_State: un reset o load que deja varios
+// harts corta la grabacion.
+void reverse_restart(void) {
+    ncheckpoints = log_len = 0;
+    if (reverse_enabled && hart_count > 1) {
+        reverse_enabled = 0;
+        printf("Recording stopped, reverse stepping needs a single hart\n\n");
+    }
+    if (reverse_enabled) take_checkpoint();
+}
+
+void reverse_enable(void) {
+    reverse_enabled = 1;
+    reverse_restart();
+}
+
+void reverse_disable(void) {
+    reverse_enabled = 0;
+    ncheckpoints = log_len = 0;
+}
+
+// Llamado desde cycle() antes de ejecutar cada instruccion
+void reverse_checkpoint(void) {
+    if (INSTRUCTION_COUNT - checkpoints[ncheckpoints - 1].count >= CHECKPOINT_INTERVAL)
+        take_checkpoint();
+}
+
+// Llamado desde mem_write_32 con el valor que se va a pisar
+void reverse_log_store(uint64_t address, uint32_t old_value) {
+    if (undoing) return;
+    if (log_len == log_cap) {
+        log_cap = log_cap ? 2 * log_cap : 4096;
+        undo_log = realloc(undo_log, log_cap * sizeof(UndoEntry));
+    }
+    undo_log[log_len].address = address;
+    undo_log[log_len].old_value = old_value;
+    log_len++;
+}
+
+// Retrocede n instrucciones (o hasta el inicio de la grabacion). Devuelve
+// cuantas retrocedio, o -1 si no se esta grabando.
+int64_t reverse_step(uint64_t n) {
+    if (!reverse_enabled) return -1;
+    uint64_t first = checkpoints[0].count;
+    uint64_t target = INSTRUCTION_COUNT - first > n ? INSTRUCTION_COUNT - n : first;
+    uint64_t from = INSTRUCTION_COUNT;
+
+    size_t k = ncheckpoints - 1;
+    while (checkpoints[k].count > target) k--;
+
+    undoing = 1;
+    while (log_len > checkpoints[k].log_len) {
+        log_len--;
+        mem_write_32(undo_log[log_len].address, undo_log[log_len].old_value);
+    }
+    undoing = 0;
+    CURRENT_STATE = NEXT_STATE = checkpoints[k].state;
+    INSTRUCTION_COUNT = checkpoints[k].count;
+    RUN_BIT = checkpoints[k].run_bit;
+    guest_brk = checkpoints[k].brk;
+    guest_mmap_top = checkpoints[k].mmap_top;
+    ncheckpoints = k + 1;
+
+    // La re-ejecucion vuelve a grabar los stores, asi el log queda consistente
+    while (INSTRUCTION_COUNT < target && RUN_BIT)
+        cycle();
+    return from - INSTRUCTION_COUNT;
+}
+
+void reverse_status(FILE *out) {
+    if (!reverse_enabled) {
+        fprintf(out, "Recording is off, use 'record on'\n\n");
+        return;
+    }
+    fprintf(out, "Recording since instruction %" PRIu64 ": %zu checkpoints, %zu stores logged (%zu KiB)\n\n",
+            checkpoints[0].count, ncheckpoints, log_len,
+            (ncheckpoints * sizeof(Checkpoint) + log_len * sizeof(UndoEntry)) / 1024);
+}
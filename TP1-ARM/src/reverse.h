@@ -0,0 +1,21 @@
+#ifndef REVERSE_H
+#define REVERSE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Ejecucion hacia atras: checkpoints periodicos de CPU_State mas un log con
+// el valor anterior de cada palabra escrita. Volver N instrucciones es
+// deshacer el log hasta un checkpoint y re-ejecutar lo que falta. Solo con
+// un hart.
+extern int reverse_enabled;
+
+void reverse_enable(void);
+void reverse_disable(void);
+void reverse_restart(void);
+void reverse_checkpoint(void);
+void reverse_log_store(uint64_t address, uint32_t old_value);
+int64_t reverse_step(uint64_t n);
+void reverse_status(FILE *out);
+
+#endif
@@ -27,40 +27,48 @@
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
+#include <time.h>
 #include "shell.h"
+#include "handlers.h"
+#include "prof.h"
+#include "hotspot.h"
+#include "stats.h"
+#include "perfctr.h"
+#include "cache.h"
+#include "bpred.h"
+#include "pipeline.h"
+#include "ooo.h"
+#include "trace.h"
+#include "snapshot.h"
+#include "reverse.h"
+#include "fuzz.h"
+#include "coverage.h"
+#include "hart.h"
+#include "device.h"
+#include "event.h"
 
 /***************************************************************/
 /* Main memory.                                                */
 /***************************************************************/
 
-#define MEM_DATA_START  0x10000000
-#define MEM_DATA_SIZE   0x00100000
-#define MEM_TEXT_START  0x00400000
-#define MEM_TEXT_SIZE   0x00100000
-#define MEM_STACK_START 0xfffffffc
-#define MEM_STACK_SIZE  0x00100000
-
-typedef struct {
-    uint64_t start, size;
-    uint8_t *mem;
-} mem_region_t;
-
 /* memory will be dynamically allocated at initialization */
-mem_region_t MEM_REGIONS[] = {
+mem_region_t MEM_REGIONS[MEM_NREGIONS] = {
     { MEM_TEXT_START, MEM_TEXT_SIZE, NULL },
     { MEM_DATA_START, MEM_DATA_SIZE, NULL },
     { MEM_STACK_START, MEM_STACK_SIZE, NULL },
 };
 
-#define MEM_NREGIONS (sizeof(MEM_REGIONS)/sizeof(mem_region_t))
-
 /***************************************************************/
 /* CPU State info.                                             */
 /***************************************************************/
 
-CPU_State CURRENT_STATE, NEXT_STATE;
-int RUN_BIT;	/* run bit */
-int INSTRUCTION_COUNT;
+HART_LOCAL CPU_State CURRENT_STATE, NEXT_STATE;
+HART_LOCAL int RUN_BIT;	/* run bit */
+HART_LOCAL uint64_t INSTRUCTION_COUNT;
+HART_LOCAL jmp_buf *FAULT_JMP = NULL;
+
+uint64_t PROGRAM_ENTRY[MAX_PROGRAMS];
+int PROGRAM_COUNT = 0;
 
 
 /***************************************************************/
@@ -86,6 +94,12 @@ uint32_t mem_read_32(uint64_t address)
         }
     }
 
+    if (device_count) {
+        const Device *dev = device_find(address);
+        if (dev) return dev->read((address - dev->start) & ~3ULL);
+    }
+    if (FAULT_JMP)
+        longjmp(*FAULT_JMP, FAULT_MEMORY);
     return 0;
 }
 
@@ -103,7 +117,14 @@ void mem_write_32(uint64_t address, uint32_t value)
         if (address >= MEM_REGIONS[i].start &&
                 address < (MEM_REGIONS[i].start + MEM_REGIONS[i].size)) {
             uint32_t offset = address - MEM_REGIONS[i].start;
+            uint32_t page = offset >> MEM_PAGE_SHIFT;
 
+            if (!(MEM_REGIONS[i].dirty[page >> 6] & (1ULL << (page & 63))))
+                mem_page_first_write(i, page);
+            if (reverse_enabled)
+                reverse_log_store(address,
+                    MEM_REGIONS[i].mem[offset+0] | (MEM_REGIONS[i].mem[offset+1] << 8) |
+                    (MEM_REGIONS[i].mem[offset+2] << 16) | ((uint32_t)MEM_REGIONS[i].mem[offset+3] << 24));
             MEM_REGIONS[i].mem[offset+3] = (value >> 24) & 0xFF;
             MEM_REGIONS[i].mem[offset+2] = (value >> 16) & 0xFF;
             MEM_REGIONS[i].mem[offset+1] = (value >>  8) & 0xFF;
@@ -111,7 +132,68 @@ void mem_write_32(uint64_t address, uint32_t value)
             return;
         }
     }
+
+    if (device_count) {
+        const Device *dev = device_find(address);
+        if (dev) {
+            dev->write((address - dev->start) & ~3ULL, value);
+            return;
+        }
+    }
+    if (FAULT_JMP)
+        longjmp(*FAULT_JMP, FAULT_MEMORY);
+}
+/***************************************************************/
+/*                                                             */
+/* Procedure: mem_region_ptr                                   */
+/*                                                             */
+/* Purpose: Host pointer to size bytes of guest memory, for    */
+/*          atomics and zero-copy I/O. NULL if the range is    */
+/*          not inside a single region. Writers get the same   */
+/*          dirty and undo tracking as mem_write_32.           */
+/*                                                             */
+/***************************************************************/
+uint8_t *mem_region_ptr(uint64_t address, uint64_t size, int is_write)
+{
+    int i;
+    for (i = 0; i < MEM_NREGIONS; i++) {
+        if (address >= MEM_REGIONS[i].start &&
+                address + size <= MEM_REGIONS[i].start + MEM_REGIONS[i].size &&
+                address + size >= address) {
+            uint64_t offset = address - MEM_REGIONS[i].start;
+            uint64_t page, w;
+
+            if (is_write && size) {
+                for (page = offset >> MEM_PAGE_SHIFT; page <= (offset + size - 1) >> MEM_PAGE_SHIFT; page++)
+                    if (!(MEM_REGIONS[i].dirty[page >> 6] & (1ULL << (page & 63))))
+                        mem_page_first_write(i, page);
+                if (reverse_enabled)
+                    for (w = offset & ~3ULL; w < offset + size; w += 4)
+                        reverse_log_store(MEM_REGIONS[i].start + w, mem_read_32(MEM_REGIONS[i].start + w));
+            }
+            return MEM_REGIONS[i].mem + offset;
+        }
+    }
+    return NULL;
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure: mem_host_ptr                                     */
+/*                                                             */
+/* Purpose: Like mem_region_ptr, but a miss is a memory fault  */
+/*          when FAULT_JMP is set.                             */
+/*                                                             */
+/***************************************************************/
+uint8_t *mem_host_ptr(uint64_t address, uint64_t size, int is_write)
+{
+    uint8_t *p = mem_region_ptr(address, size, is_write);
+
+    if (!p && FAULT_JMP)
+        longjmp(*FAULT_JMP, FAULT_MEMORY);
+    return p;
 }
+
 /***************************************************************/
 /*                                                             */
 /* Procedure : help                                            */
@@ -126,6 +208,49 @@ void help() {
   printf("mdump low high   -  dump memory from low to high      \n");
   printf("rdump            -  dump the register & bus values    \n");
   printf("input reg_no reg_value - set GPR reg_no to reg_value  \n");
+  printf("prof             -  host time per phase and handler   \n");
+  printf("hot on [file.s]  -  count executions per guest PC     \n");
+  printf("hot off          -  stop counting                     \n");
+  printf("hot report [pfx] -  top PCs, write pfx.txt/pfx.folded \n");
+  printf("stats            -  dynamic instruction mix           \n");
+  printf("stats csv file   -  export the instruction mix as CSV \n");
+  printf("stats on|off     -  print the mix when the guest halts\n");
+  printf("stats reset      -  clear the counters                \n");
+  printf("ubench n         -  time n decodes and memory accesses\n");
+  printf("perfstat on|off  -  host HW counters around go/run    \n");
+  printf("perfstat         -  show the last host counter values \n");
+  printf("cache on|off|reset - guest L1I/L1D/L2 timing model    \n");
+  printf("cache            -  hit rates and stalls per PC       \n");
+  printf("cache l1i|l1d|l2 size assoc line [lru|plru] [wb|wt]   \n");
+  printf("cache latency l2 mem - miss latencies in cycles       \n");
+  printf("bpred on|off|reset - branch predictor models          \n");
+  printf("bpred            -  mispredicts per predictor and PC  \n");
+  printf("bpred penalty n  -  mispredict penalty in cycles      \n");
+  printf("pipeline on|off|reset - in-order 5-stage timing model \n");
+  printf("pipeline forward on|off - toggle the forwarding paths \n");
+  printf("pipeline mul n   -  MUL latency in EX cycles          \n");
+  printf("pipeline branch n - taken-branch flush penalty        \n");
+  printf("ooo on|off|reset -  out-of-order core timing model    \n");
+  printf("ooo              -  IPC, ROB occupancy and stalls     \n");
+  printf("ooo width|rob|rs|lsq n - core configuration           \n");
+  printf("trace on <file>  -  record a binary trace (tracedump) \n");
+  printf("trace off        -  flush and close the trace         \n");
+  printf("save <file>      -  write a snapshot of the simulator \n");
+  printf("load <file>      -  restore a snapshot                \n");
+  printf("mark             -  remember the state for reset      \n");
+  printf("reset            -  restore the marked state (dirty pages only)\n");
+  printf("record on|off    -  record history for reverse stepping\n");
+  printf("rstep n          -  step back n instructions          \n");
+  printf("rcontinue        -  go back to the start of the record\n");
+  printf("fuzz regs|data|insn n [budget] [seed] - fuzz from the current state\n");
+  printf("coverage on [file] - edge coverage, written after HLT \n");
+  printf("coverage off|reset - stop or clear the coverage map   \n");
+  printf("coverage merge <file> - add a map from another run    \n");
+  printf("harts n          -  run n harts over shared memory     \n");
+  printf("harts quantum q  -  instructions per scheduler turn  \n");
+  printf("harts threads on|off - one host thread per hart (relaxed)\n");
+  printf("harts select k   -  hart shown by rdump and input     \n");
+  printf("devices          -  list memory-mapped devices        \n");
   printf("?                -  display this help menu            \n");
   printf("quit             -  exit the program                  \n\n");
 }
@@ -139,11 +264,85 @@ void help() {
 /***************************************************************/
 void cycle() {                                                
 
+  if (reverse_enabled)
+    reverse_checkpoint();
   process_instruction();
+  PROF_START(t);
   CURRENT_STATE = NEXT_STATE;
+  PROF_LAP(t, PROF_COMMIT);
   INSTRUCTION_COUNT++;
 }
 
+/***************************************************************/
+/*                                                             */
+/* Procedure : halt_reports                                    */
+/*                                                             */
+/* Purpose   : Print the enabled end-of-run reports            */
+/*                                                             */
+/***************************************************************/
+void halt_reports() {
+  PROF_HALT();
+  if (stats_summary)
+    stats_report(stdout);
+  if (coverage_enabled && coverage_export(coverage_path) == 0)
+    printf("Coverage: %u edges written to %s\n\n", coverage_count(coverage_map), coverage_path);
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : perf_begin / perf_end                           */
+/*                                                             */
+/* Purpose   : Measure host counters around a go/run call      */
+/*                                                             */
+/***************************************************************/
+uint64_t perf_start_count;
+
+void perf_begin() {
+  if (!perfctr_enabled)
+    return;
+  perf_start_count = INSTRUCTION_COUNT;
+  perfctr_start();
+}
+
+void perf_end() {
+  if (!perfctr_enabled)
+    return;
+  perfctr_stop(INSTRUCTION_COUNT - perf_start_count);
+  perfctr_report(stdout);
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : simulate                                        */
+/*                                                             */
+/* Purpose   : Execute up to budget instructions. The loop     */
+/*             runs uninterrupted until the next event         */
+/*             deadline, then services the due events.         */
+/*                                                             */
+/***************************************************************/
+uint64_t simulate(uint64_t budget) {
+  uint64_t done = 0, chunk, start;
+
+  while (RUN_BIT && done < budget) {
+    chunk = budget - done;
+    if (event_deadline <= INSTRUCTION_COUNT)
+      chunk = 0;
+    else if (event_deadline - INSTRUCTION_COUNT < chunk)
+      chunk = event_deadline - INSTRUCTION_COUNT;
+    if (hart_count > 1) {
+      done += hart_run(chunk);
+    } else {
+      start = INSTRUCTION_COUNT;
+      while (RUN_BIT && INSTRUCTION_COUNT - start < chunk)
+        cycle();
+      done += INSTRUCTION_COUNT - start;
+    }
+    if (event_deadline != EVENT_NEVER)
+      event_service(INSTRUCTION_COUNT);
+  }
+  return done;
+}
+
 /***************************************************************/
 /*                                                             */
 /* Procedure : run n                                           */
@@ -152,21 +351,21 @@ void cycle() {
 /*                                                             */
 /***************************************************************/
 void run(int num_cycles) {                                      
-  int i;
-
   if (RUN_BIT == FALSE) {
     printf("Can't simulate, Simulator is halted\n\n");
     return;
   }
 
   printf("Simulating for %d cycles...\n\n", num_cycles);
-  for (i = 0; i < num_cycles; i++) {
-    if (RUN_BIT == FALSE) {
-	    printf("Simulator halted\n\n");
-	    break;
-    }
-    cycle();
+  if (num_cycles <= 0)
+    return;
+  perf_begin();
+  simulate(num_cycles);
+  if (RUN_BIT == FALSE) {
+    printf("Simulator halted\n\n");
+    halt_reports();
   }
+  perf_end();
 }
 
 /***************************************************************/ 
@@ -207,11 +406,14 @@ void rdump(FILE * dumpsim_file) {
 
   printf("\nCurrent register/bus values :\n");
   printf("-------------------------------------\n");
-  printf("Instruction Count : %u\n", INSTRUCTION_COUNT);
+  printf("Instruction Count : %" PRIu64 "\n", INSTRUCTION_COUNT);
+  hart_dump(stdout);
+  pipeline_dump(stdout);
   printf("PC                : 0x%" PRIx64 "\n", CURRENT_STATE.PC);
   printf("Registers:\n");
   for (k = 0; k < ARM_REGS; k++)
     printf("X%d: 0x%" PRIx64 "\n", k, CURRENT_STATE.REGS[k]);
+  printf("SP: 0x%" PRIx64 "\n", CURRENT_STATE.REGS[REG_SP]);
   printf("FLAG_N: %d\n", CURRENT_STATE.FLAG_N);
   printf("FLAG_Z: %d\n", CURRENT_STATE.FLAG_Z);
   printf("\n");
@@ -219,11 +421,14 @@ void rdump(FILE * dumpsim_file) {
   /* dump the state information into the dumpsim file */
   fprintf(dumpsim_file, "\nCurrent register/bus values :\n");
   fprintf(dumpsim_file, "-------------------------------------\n");
-  fprintf(dumpsim_file, "Instruction Count : %u\n", INSTRUCTION_COUNT);
+  fprintf(dumpsim_file, "Instruction Count : %" PRIu64 "\n", INSTRUCTION_COUNT);
+  hart_dump(dumpsim_file);
+  pipeline_dump(dumpsim_file);
   fprintf(dumpsim_file, "PC                : 0x%" PRIx64 "\n", CURRENT_STATE.PC);
   fprintf(dumpsim_file, "Registers:\n");
   for (k = 0; k < ARM_REGS; k++)
     fprintf(dumpsim_file, "X%d: 0x%" PRIx64 "\n", k, CURRENT_STATE.REGS[k]);
+  fprintf(dumpsim_file, "SP: 0x%" PRIx64 "\n", CURRENT_STATE.REGS[REG_SP]);
   fprintf(dumpsim_file, "FLAG_N: %d\n", CURRENT_STATE.FLAG_N);
   fprintf(dumpsim_file, "FLAG_Z: %d\n", CURRENT_STATE.FLAG_Z);
   fprintf(dumpsim_file, "\n");
@@ -242,15 +447,542 @@ void go(FILE * dumpsim_file) {
   }
 
   printf("Simulating...\n\n");
-  while (RUN_BIT) {
-    cycle();
-    //printf("Going\n");
-    //rdump(dumpsim_file);
-    //mdump(dumpsim_file, MEM_DATA_START, MEM_DATA_START+0x100);
-  }
+  perf_begin();
+  simulate(UINT64_MAX);
+  perf_end();
   printf("Simulator halted\n\n");
+  halt_reports();
+}
+
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : ubench n                                        */
+/*                                                             */
+/* Purpose   : Time the decoder and the memory helpers in      */
+/*             isolation, without changing the guest state.    */
+/*                                                             */
+/***************************************************************/
+double elapsed_ns(struct timespec *t0, struct timespec *t1) {
+  return (t1->tv_sec - t0->tv_sec) * 1e9 + (t1->tv_nsec - t0->tv_nsec);
+}
+
+void ubench(int iterations) {
+  struct timespec t0, t1;
+  uint32_t words[MAX_OPCODES];
+  volatile uintptr_t sink = 0;
+  uint64_t *saved;
+  size_t nwords;
+  int i, r, was_recording;
+
+  if (iterations <= 0)
+    return;
+
+  /* one encoding per opcode table entry */
+  for (i = 0; i < OPCODE_COUNT; i++) {
+    int len = OPCODE_TABLE[i].length;
+    words[i] = (OPCODE_TABLE[i].pattern >> ((32 - len) % 4)) << (32 - len);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (i = 0; i < iterations; i++)
+    sink += (uintptr_t)decode_instruction(words[i % OPCODE_COUNT]);
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  printf("Decode    : %.2f ns/instr\n", elapsed_ns(&t0, &t1) / iterations);
+
+  /* The write-back must not look like a guest store: with every page
+     already dirty nothing is copied to the mark backup, nothing is logged
+     for reverse, and the dirty bitmap is put back afterwards. */
+  for (r = 0; MEM_REGIONS[r].start != MEM_DATA_START; r++)
+    ;
+  nwords = mem_region_pages(r) / 64 + 1;
+  saved = malloc(nwords * sizeof(uint64_t));
+  memcpy(saved, MEM_REGIONS[r].dirty, nwords * sizeof(uint64_t));
+  memset(MEM_REGIONS[r].dirty, 0xFF, nwords * sizeof(uint64_t));
+  was_recording = reverse_enabled;
+  reverse_enabled = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (i = 0; i < iterations; i++) {
+    uint64_t address = MEM_DATA_START + ((uint64_t)i * 4 & (MEM_DATA_SIZE - 1));
+    mem_write_32(address, mem_read_32(address));
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  printf("Memory op : %.2f ns/access\n\n", elapsed_ns(&t0, &t1) / (2.0 * iterations));
+
+  reverse_enabled = was_recording;
+  memcpy(MEM_REGIONS[r].dirty, saved, nwords * sizeof(uint64_t));
+  free(saved);
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : unsafe_model_on                                 */
+/*                                                             */
+/* Purpose   : Name of an analysis model that is on and keeps  */
+/*             unlocked global state, or NULL. Those can't run */
+/*             with harts on host threads.                     */
+/*                                                             */
+/***************************************************************/
+const char *unsafe_model_on() {
+  if (retire_consumers & RETIRE_OOO) return "ooo";
+  if (retire_consumers & RETIRE_PIPELINE) return "pipeline";
+  if (retire_consumers & RETIRE_TRACE) return "trace";
+  if (cache_enabled) return "cache";
+  if (bpred_enabled) return "bpred";
+  if (hotspot_enabled) return "hot";
+  if (reverse_enabled) return "record";
+  return NULL;
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : threads_refuse                                  */
+/*                                                             */
+/* Purpose   : Refuse to turn model on while harts run on host */
+/*             threads. Returns 1 if refused.                  */
+/*                                                             */
+/***************************************************************/
+int threads_refuse(const char *model) {
+  if (!hart_threads_enabled())
+    return 0;
+  printf("Can't turn %s on with harts on host threads, use 'harts threads off'\n\n", model);
+  return 1;
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : hot_command                                     */
+/*                                                             */
+/* Purpose   : Parse the arguments of the hot command.         */
+/*                                                             */
+/***************************************************************/
+void hot_command() {
+  char line[256], action[16], arg[240];
+  int nargs;
+
+  if (fgets(line, sizeof(line), stdin) == NULL)
+    return;
+  nargs = sscanf(line, "%15s %239s", action, arg);
+  if (nargs < 1) {
+    printf("Usage: hot on [file.s] | hot off | hot report [prefix]\n\n");
+    return;
+  }
+
+  if (strcmp(action, "on") == 0) {
+    if (threads_refuse("hot"))
+      ;
+    else if (hotspot_enable(nargs == 2 ? arg : NULL) != 0)
+      printf("Error: Can't open source map %s\n\n", arg);
+  } else if (strcmp(action, "off") == 0) {
+    hotspot_disable();
+  } else if (strcmp(action, "report") == 0) {
+    if (hotspot_report(nargs == 2 ? arg : NULL, 10) != 0)
+      printf("Error: No hot spot data or can't write %s\n\n", arg);
+  } else {
+    printf("Usage: hot on [file.s] | hot off | hot report [prefix]\n\n");
+  }
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : stats_command                                   */
+/*                                                             */
+/* Purpose   : Parse the arguments of the stats command.       */
+/*                                                             */
+/***************************************************************/
+void stats_command() {
+  char line[256], action[16], arg[240];
+  int nargs;
+
+  if (fgets(line, sizeof(line), stdin) == NULL)
+    return;
+  nargs = sscanf(line, "%15s %239s", action, arg);
+
+  if (nargs < 1)
+    stats_report(stdout);
+  else if (strcmp(action, "csv") == 0 && nargs == 2) {
+    if (stats_export_csv(arg) != 0)
+      printf("Error: Can't write %s\n\n", arg);
+  } else if (strcmp(action, "on") == 0)
+    stats_summary = 1;
+  else if (strcmp(action, "off") == 0)
+    stats_summary = 0;
+  else if (strcmp(action, "reset") == 0)
+    stats_reset();
+  else
+    printf("Usage: stats [csv file | on | off | reset]\n\n");
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : perfstat_command                                */
+/*                                                             */
+/* Purpose   : Parse the arguments of the perfstat command.    */
+/*                                                             */
+/***************************************************************/
+void perfstat_command() {
+  char line[256], action[16];
+
+  if (fgets(line, sizeof(line), stdin) == NULL)
+    return;
+
+  if (sscanf(line, "%15s", action) != 1)
+    perfctr_report(stdout);
+  else if (strcmp(action, "on") == 0) {
+    if (perfctr_enable() == 0)
+      printf("Error: perf_event_open is not available\n\n");
+  } else if (strcmp(action, "off") == 0)
+    perfctr_disable();
+  else
+    printf("Usage: perfstat [on | off]\n\n");
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : cache_command                                   */
+/*                                                             */
+/* Purpose   : Parse the arguments of the cache command.       */
+/*                                                             */
+/***************************************************************/
+void cache_command() {
+  char line[256], action[16], size[16], repl[8] = "lru", policy[8] = "wb";
+  unsigned assoc, line_size, l2, mem;
+  int level = -1;
+
+  if (fgets(line, sizeof(line), stdin) == NULL)
+    return;
+
+  if (sscanf(line, "%15s", action) != 1)
+    cache_report(stdout, 10);
+  else if (strcmp(action, "on") == 0) {
+    if (threads_refuse("cache"))
+      ;
+    else if (cache_enable() != 0)
+      printf("Error: Invalid cache geometry\n\n");
+  } else if (strcmp(action, "off") == 0)
+    cache_disable();
+  else if (strcmp(action, "reset") == 0)
+    cache_reset();
+  else if (strcmp(action, "latency") == 0 && sscanf(line, "%*s %u %u", &l2, &mem) == 2)
+    cache_set_latency(l2, mem);
+  else {
+    if (strcmp(action, "l1i") == 0) level = CACHE_L1I;
+    if (strcmp(action, "l1d") == 0) level = CACHE_L1D;
+    if (strcmp(action, "l2") == 0) level = CACHE_L2;
+    if (level < 0 || sscanf(line, "%*s %15s %u %u %7s %7s", size, &assoc, &line_size, repl, policy) < 3) {
+      printf("Usage: cache [on | off | reset | latency l2 mem | l1i|l1d|l2 size[K] assoc line [lru|plru] [wb|wt]]\n\n");
+      return;
+    }
+    char *unit;
+    unsigned long bytes = strtoul(size, &unit, 0);
+    if (*unit == 'K' || *unit == 'k')
+      bytes *= 1024;
+    if (cache_configure(level, bytes, assoc, line_size, strcmp(repl, "plru") == 0 ? REPL_PLRU : REPL_LRU,
+                        strcmp(policy, "wt") == 0 ? WRITE_THROUGH : WRITE_BACK) != 0)
+      printf("Error: Invalid cache geometry\n\n");
+  }
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : bpred_command                                   */
+/*                                                             */
+/* Purpose   : Parse the arguments of the bpred command.       */
+/*                                                             */
+/***************************************************************/
+void bpred_command() {
+  char line[256], action[16];
+  unsigned cycles;
+
+  if (fgets(line, sizeof(line), stdin) == NULL)
+    return;
+
+  if (sscanf(line, "%15s", action) != 1)
+    bpred_report(stdout, 10);
+  else if (strcmp(action, "on") == 0) {
+    if (!threads_refuse("bpred"))
+      bpred_enable();
+  }
+  else if (strcmp(action, "off") == 0)
+    bpred_disable();
+  else if (strcmp(action, "reset") == 0)
+    bpred_reset();
+  else if (strcmp(action, "penalty") == 0 && sscanf(line, "%*s %u", &cycles) == 1)
+    bpred_set_penalty(cycles);
+  else
+    printf("Usage: bpred [on | off | reset | penalty n]\n\n");
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : pipeline_command                                */
+/*                                                             */
+/* Purpose   : Configure the in-order pipeline timing model    */
+/*                                                             */
+/***************************************************************/
+void pipeline_command() {
+  char line[256], action[16], arg[16];
+  unsigned cycles;
+
+  if (fgets(line, sizeof(line), stdin) == NULL)
+    return;
+
+  if (sscanf(line, "%15s", action) != 1) {
+    if (!pipeline_dump(stdout))
+      printf("Pipeline model is off\n");
+    printf("\n");
+  }
+  else if (strcmp(action, "on") == 0) {
+    if (!threads_refuse("pipeline"))
+      pipeline_enable();
+  }
+  else if (strcmp(action, "off") == 0)
+    pipeline_disable();
+  else if (strcmp(action, "reset") == 0)
+    pipeline_reset();
+  else if (strcmp(action, "forward") == 0 && sscanf(line, "%*s %15s", arg) == 1
+           && (strcmp(arg, "on") == 0 || strcmp(arg, "off") == 0))
+    pipeline_set_forwarding(strcmp(arg, "on") == 0);
+  else if (strcmp(action, "mul") == 0 && sscanf(line, "%*s %u", &cycles) == 1)
+    pipeline_set_mul_latency(cycles);
+  else if (strcmp(action, "branch") == 0 && sscanf(line, "%*s %u", &cycles) == 1)
+    pipeline_set_branch_penalty(cycles);
+  else
+    printf("Usage: pipeline [on | off | reset | forward on|off | mul n | branch n]\n\n");
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : ooo_command                                     */
+/*                                                             */
+/* Purpose   : Configure the out-of-order core timing model    */
+/*                                                             */
+/***************************************************************/
+void ooo_command() {
+  static const char *params[OOO_NPARAMS] = { "width", "rob", "rs", "lsq" };
+  char line[256], action[16];
+  unsigned value;
+  int i;
+
+  if (fgets(line, sizeof(line), stdin) == NULL)
+    return;
+
+  if (sscanf(line, "%15s", action) != 1) {
+    ooo_report(stdout, 10);
+    return;
+  }
+  if (strcmp(action, "on") == 0) {
+    if (!threads_refuse("ooo"))
+      ooo_enable();
+    return;
+  }
+  if (strcmp(action, "off") == 0) {
+    ooo_disable();
+    return;
+  }
+  if (strcmp(action, "reset") == 0) {
+    ooo_reset();
+    return;
+  }
+  for (i = 0; i < OOO_NPARAMS; i++)
+    if (strcmp(action, params[i]) == 0 && sscanf(line, "%*s %u", &value) == 1
+        && ooo_set_param(i, value) == 0)
+      return;
+  printf("Usage: ooo [on | off | reset | width n | rob n | rs n | lsq n]\n\n");
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : trace_command                                   */
+/*                                                             */
+/* Purpose   : Start or stop the binary trace recorder         */
+/*                                                             */
+/***************************************************************/
+void trace_command() {
+  char line[256], action[16], path[200];
+
+  if (fgets(line, sizeof(line), stdin) == NULL)
+    return;
+
+  if (sscanf(line, "%15s", action) != 1)
+    trace_status(stdout);
+  else if (strcmp(action, "on") == 0 && sscanf(line, "%*s %199s", path) == 1) {
+    if (hart_count > 1)
+      printf("Can't trace with several harts, the records carry no hart id\n\n");
+    else if (trace_start(path) != 0)
+      printf("Error: can't open %s\n\n", path);
+  }
+  else if (strcmp(action, "off") == 0) {
+    trace_stop();
+    trace_status(stdout);
+  }
+  else
+    printf("Usage: trace [on <file> | off]\n\n");
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : snapshot_command                                */
+/*                                                             */
+/* Purpose   : Save or load a snapshot of the simulator state  */
+/*                                                             */
+/***************************************************************/
+void snapshot_command(int save) {
+  char path[256];
+
+  if (scanf("%255s", path) != 1)
+    return;
+
+  if (save && snapshot_save(path) != 0)
+    printf("Error: can't write snapshot %s\n\n", path);
+  else if (!save && snapshot_load(path) != 0)
+    printf("Error: %s is not a valid snapshot\n\n", path);
+  else if (!save)
+    reverse_restart();
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : record_command                                  */
+/*                                                             */
+/* Purpose   : Toggle recording for reverse execution          */
+/*                                                             */
+/***************************************************************/
+void record_command() {
+  char line[256], action[16];
+
+  if (fgets(line, sizeof(line), stdin) == NULL)
+    return;
+
+  if (sscanf(line, "%15s", action) != 1)
+    reverse_status(stdout);
+  else if (strcmp(action, "on") == 0) {
+    if (hart_count > 1)
+      printf("Can't record with several harts, use 'harts 1'\n\n");
+    else if (!threads_refuse("record"))
+      reverse_enable();
+  }
+  else if (strcmp(action, "off") == 0)
+    reverse_disable();
+  else
+    printf("Usage: record [on | off]\n\n");
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : reverse_command                                 */
+/*                                                             */
+/* Purpose   : Step back n instructions, or to the start of    */
+/*             the recording when n is negative.               */
+/*                                                             */
+/***************************************************************/
+void reverse_command(int n) {
+  int64_t back = reverse_step(n < 0 ? UINT64_MAX : (uint64_t)n);
+
+  if (back < 0)
+    printf("Can't step back, use 'record on' first\n\n");
+  else
+    printf("Stepped back %" PRId64 " instructions to %" PRIu64 "\n\n", back, INSTRUCTION_COUNT);
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : fuzz_command                                    */
+/*                                                             */
+/* Purpose   : Fuzz the guest from the current state           */
+/*                                                             */
+/***************************************************************/
+void fuzz_command() {
+  static const char *modes[] = { "regs", "data", "insn" };
+  char line[256], mode[16];
+  uint64_t iterations, budget = 100000, seed = 0;
+  int i;
+
+  if (fgets(line, sizeof(line), stdin) == NULL)
+    return;
+
+  if (sscanf(line, "%15s %" SCNu64 " %" SCNu64 " %" SCNu64, mode, &iterations, &budget, &seed) >= 2)
+    for (i = 0; i < 3; i++)
+      if (strcmp(mode, modes[i]) == 0) {
+        fuzz_run(i, iterations, budget, seed);
+        reverse_restart();
+        return;
+      }
+  printf("Usage: fuzz [regs | data | insn] iterations [budget] [seed]\n\n");
+}
+
+/***************************************************************/
+/*                                                             */
+/* Procedure : coverage_command                                */
+/*                                                             */
+/* Purpose   : Control the edge coverage map                   */
+/*                                                             */
+/***************************************************************/
+void coverage_command() {
+  char line[256], action[16], path[200];
+
+  if (fgets(line, sizeof(line), stdin) == NULL)
+    return;
+
+  if (sscanf(line, "%15s", action) != 1)
+    printf("Coverage %s: %u edges (%s)\n\n", coverage_enabled ? "on" : "off",
+           coverage_count(coverage_map), coverage_path);
+  else if (strcmp(action, "on") == 0) {
+    if (sscanf(line, "%*s %199s", path) == 1)
+      snprintf(coverage_path, sizeof(coverage_path), "%s", path);
+    coverage_enabled = 1;
+  }
+  else if (strcmp(action, "off") == 0)
+    coverage_enabled = 0;
+  else if (strcmp(action, "reset") == 0)
+    coverage_clear();
+  else if (strcmp(action, "merge") == 0 && sscanf(line, "%*s %199s", path) == 1) {
+    if (coverage_merge(path) != 0)
+      printf("Error: %s is not a coverage map\n\n", path);
+  }
+  else
+    printf("Usage: coverage [on [file] | off | reset | merge <file>]\n\n");
 }
 
+/***************************************************************/
+/*                                                             */
+/* Procedure : harts_command                                   */
+/*                                                             */
+/* Purpose   : Configure the harts sharing guest memory        */
+/*                                                             */
+/***************************************************************/
+void harts_command() {
+  char line[256], action[16], arg[16];
+  unsigned value;
+
+  if (fgets(line, sizeof(line), stdin) == NULL)
+    return;
+
+  if (sscanf(line, "%15s", action) != 1) {
+    hart_dump(stdout);
+    printf("\n");
+  }
+  else if (strcmp(action, "quantum") == 0 && sscanf(line, "%*s %u", &value) == 1)
+    hart_set_quantum(value);
+  else if (strcmp(action, "threads") == 0 && sscanf(line, "%*s %15s", arg) == 1
+           && strcmp(arg, "on") == 0 && unsafe_model_on())
+    printf("Can't use host threads while %s is on, turn it off first\n\n", unsafe_model_on());
+  else if (strcmp(action, "threads") == 0 && sscanf(line, "%*s %15s", arg) == 1
+           && (strcmp(arg, "on") == 0 || strcmp(arg, "off") == 0))
+    hart_set_threads(strcmp(arg, "on") == 0);
+  else if (strcmp(action, "select") == 0 && sscanf(line, "%*s %u", &value) == 1
+           && hart_select(value) == 0)
+    ;
+  else if (sscanf(line, "%u", &value) == 1 && value > 1 && (retire_consumers & RETIRE_TRACE))
+    printf("Can't run several harts while tracing, use 'trace off'\n\n");
+  else if (sscanf(line, "%u", &value) == 1 && value > 1 && reverse_enabled)
+    printf("Can't run several harts while recording, use 'record off'\n\n");
+  else if (sscanf(line, "%u", &value) == 1 && hart_configure(value) == 0)
+    ;
+  else
+    printf("Usage: harts [n | quantum q | threads on|off | select k]\n\n");
+}
 
 /***************************************************************/
 /*                                                             */
@@ -280,6 +1012,10 @@ void get_command(FILE * dumpsim_file) {
 
   case 'M':
   case 'm':
+    if (buffer[1] == 'a' || buffer[1] == 'A') {
+        snapshot_mark();
+        break;
+    }
     if (scanf("%i %i", &start, &stop) != 2)
         break;
 
@@ -290,6 +1026,37 @@ void get_command(FILE * dumpsim_file) {
     help();
     break;
 
+  case 'P':
+  case 'p':
+    if (buffer[1] == 'e' || buffer[1] == 'E')
+      perfstat_command();
+    else if (buffer[1] == 'i' || buffer[1] == 'I')
+      pipeline_command();
+    else
+      prof_report(stdout);
+    break;
+
+  case 'H':
+  case 'h':
+    if (buffer[1] == 'a' || buffer[1] == 'A')
+      harts_command();
+    else
+      hot_command();
+    break;
+
+  case 'S':
+  case 's':
+    if (buffer[1] == 'a' || buffer[1] == 'A')
+      snapshot_command(1);
+    else
+      stats_command();
+    break;
+
+  case 'L':
+  case 'l':
+    snapshot_command(0);
+    break;
+
   case 'Q':
   case 'q':
     printf("Bye.\n");
@@ -299,16 +1066,68 @@ void get_command(FILE * dumpsim_file) {
   case 'r':
     if (buffer[1] == 'd' || buffer[1] == 'D')
 	    rdump(dumpsim_file);
+    else if ((buffer[1] == 'e' || buffer[1] == 'E') && (buffer[2] == 's' || buffer[2] == 'S')) {
+	    printf("Restored %" PRIu64 " pages\n\n", snapshot_reset());
+	    reverse_restart();
+    }
+    else if ((buffer[1] == 'e' || buffer[1] == 'E') && (buffer[2] == 'c' || buffer[2] == 'C'))
+	    record_command();
+    else if (buffer[1] == 's' || buffer[1] == 'S') {
+	    if (scanf("%d", &cycles) != 1 || cycles < 0) break;
+	    reverse_command(cycles);
+    }
+    else if (buffer[1] == 'c' || buffer[1] == 'C')
+	    reverse_command(-1);
     else {
 	    if (scanf("%d", &cycles) != 1) break;
 	    run(cycles);
     }
     break;
 
+  case 'C':
+  case 'c':
+    if (buffer[1] == 'o' || buffer[1] == 'O')
+      coverage_command();
+    else
+      cache_command();
+    break;
+
+  case 'B':
+  case 'b':
+    bpred_command();
+    break;
+
+  case 'O':
+  case 'o':
+    ooo_command();
+    break;
+
+  case 'F':
+  case 'f':
+    fuzz_command();
+    break;
+
+  case 'T':
+  case 't':
+    trace_command();
+    break;
+
+  case 'D':
+  case 'd':
+    device_list();
+    break;
+
+  case 'U':
+  case 'u':
+    if (scanf("%d", &cycles) != 1) break;
+    ubench(cycles);
+    break;
+
   case 'I':
   case 'i':
    if (scanf("%i %" PRIx64, &register_no, &register_value) != 2)
       break;
+   if (register_no == REG_ZR) register_no = REG_SP;
    CURRENT_STATE.REGS[register_no] = register_value;
    NEXT_STATE.REGS[register_no] = register_value;
    break;
@@ -332,6 +1151,9 @@ void init_memory() {
         // Extra 3 bytes to prevent buffer overflow on unaligned access.
         MEM_REGIONS[i].mem = malloc(MEM_REGIONS[i].size + 3);
         memset(MEM_REGIONS[i].mem, 0, MEM_REGIONS[i].size);
+        MEM_REGIONS[i].dirty = calloc(mem_region_pages(i) / 64 + 1, sizeof(uint64_t));
+        MEM_REGIONS[i].touched = calloc(mem_region_pages(i) / 64 + 1, sizeof(uint64_t));
+        MEM_REGIONS[i].backup = malloc(MEM_REGIONS[i].size + 3);
     }
 }
 
@@ -343,6 +1165,7 @@ void init_memory() {
 /*                                                            */
 /**************************************************************/
 void load_program(char *program_filename) {                   
+  static uint64_t text_used = 0;
   FILE * prog;
   int ii, word;
 
@@ -355,10 +1178,11 @@ void load_program(char *program_filename) {
 
   /* Read in the program. */
 
+  /* Each program starts where the previous one ended. */
   ii = 0;
   int bytes_read = EOF;
   while ((bytes_read=fscanf(prog, "%x\n", &word)) > 0) {
-    mem_write_32(MEM_TEXT_START + ii, word);
+    mem_write_32(MEM_TEXT_START + text_used + ii, word);
     ii += 4;
   }
   if (bytes_read == 0) {
@@ -366,6 +1190,9 @@ void load_program(char *program_filename) {
     exit(-1);
   }
 
+  if (PROGRAM_COUNT < MAX_PROGRAMS)
+    PROGRAM_ENTRY[PROGRAM_COUNT++] = MEM_TEXT_START + text_used;
+  text_used += ii;
   CURRENT_STATE.PC = MEM_TEXT_START;
 
   printf("Read %d words from program into memory.\n\n", ii/4);
@@ -383,6 +1210,7 @@ void initialize(char *program_filename, int num_prog_files) {
   int i;
 
   init_memory();
+  devices_init();
   for ( i = 0; i < num_prog_files; i++ ) {
     load_program(program_filename);
     while(*program_filename++ != '\0');
@@ -390,6 +1218,7 @@ void initialize(char *program_filename, int num_prog_files) {
   NEXT_STATE = CURRENT_STATE;
     
   RUN_BIT = TRUE;
+  snapshot_mark();
 }
 
 /***************************************************************/
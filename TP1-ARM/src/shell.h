@@ -16,26 +16,85 @@
 #define _SIM_SHELL_H_
 
 #include <inttypes.h>
+#include <setjmp.h>
 #define FALSE 0
 #define TRUE  1
 
 #define ARM_REGS 32
 
+/* Register file slots beyond X0-X30. Index 31 is never written, so reads of
+   XZR see zero; SP lives in its own slot and writes to XZR land in REG_SINK. */
+#define REG_ZR   31
+#define REG_SP   32
+#define REG_SINK 33
+#define ARM_REG_SLOTS 34
+
 typedef struct CPU_State_Struct {
   uint64_t PC;		          /* program counter */
-  int64_t REGS[ARM_REGS];   /* register file. */
+  int64_t REGS[ARM_REG_SLOTS]; /* register file. */
   int FLAG_N;               /* flag N */
   int FLAG_Z;               /* flag Z */
+  int EXCL_VALID;           /* exclusive monitor: set by LDXR, */
+  uint64_t EXCL_ADDR;       /* consumed by STXR */
+  uint64_t EXCL_VALUE;
 } CPU_State;
 
+/* Per-hart machine state. It is thread-local so that harts can run on
+   host threads (see hart.c); with a single hart it behaves as before. */
+#define HART_LOCAL __thread
+
 /* Data Structure for Latch */
 
-extern CPU_State CURRENT_STATE, NEXT_STATE;
+extern HART_LOCAL CPU_State CURRENT_STATE, NEXT_STATE;
+
+extern HART_LOCAL int RUN_BIT;	/* run bit */
+extern HART_LOCAL uint64_t INSTRUCTION_COUNT;
+
+/* Programs given on the command line are loaded back to back in the text
+   region; each one is the entry point of the harts assigned to it. */
+#define MAX_PROGRAMS 8
+
+extern uint64_t PROGRAM_ENTRY[MAX_PROGRAMS];
+extern int PROGRAM_COUNT;
+
+/* Main memory layout */
+
+#define MEM_DATA_START  0x10000000
+#define MEM_DATA_SIZE   0x00100000
+#define MEM_TEXT_START  0x00400000
+#define MEM_TEXT_SIZE   0x00100000
+#define MEM_STACK_START 0xfffffffc
+#define MEM_STACK_SIZE  0x00100000
 
-extern int RUN_BIT;	/* run bit */
+#define MEM_PAGE_SHIFT 12
+#define MEM_PAGE_SIZE  (1 << MEM_PAGE_SHIFT)
+
+typedef struct {
+    uint64_t start, size;
+    uint8_t *mem;
+    uint64_t *dirty;    /* page bitmap: written since the last mark */
+    uint64_t *touched;  /* page bitmap: written since init_memory */
+    uint8_t *backup;    /* page contents at the last mark, copied on first write */
+} mem_region_t;
+
+#define MEM_NREGIONS 3
+
+extern mem_region_t MEM_REGIONS[MEM_NREGIONS];
 
 uint32_t mem_read_32(uint64_t address);
 void     mem_write_32(uint64_t address, uint32_t value);
+uint8_t *mem_region_ptr(uint64_t address, uint64_t size, int is_write);
+uint8_t *mem_host_ptr(uint64_t address, uint64_t size, int is_write);
+
+void cycle();
+
+/* Guest faults. When FAULT_JMP is set, an unsupported instruction or an
+   access outside every region longjmps there with the fault code instead
+   of exiting or reading 0. */
+#define FAULT_UNSUPPORTED 1
+#define FAULT_MEMORY      2
+
+extern HART_LOCAL jmp_buf *FAULT_JMP;
 
 /* YOU IMPLEMENT THIS FUNCTION */
 void process_instruction();
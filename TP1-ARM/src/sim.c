@@ -5,79 +5,107 @@
 #include "hashmap.h"
 #include "decode.h"
 #include "handlers.h"
+#include "prof.h"
+#include "hotspot.h"
+#include "stats.h"
+#include "cache.h"
+#include "retire.h"
 
-typedef void (*InstructionHandler)(uint32_t);
-
-typedef struct {
-    uint32_t pattern;
-    int length;
-    InstructionHandler handler;
-} InstructionEntry;
+const InstructionEntry OPCODE_TABLE[] = {
+    {0xD50320, 22, handle_hint, "HINT", CLS_ALU, 0, 0},
+    {0xD61F00, 22, handle_br, "BR", CLS_BRANCH, 0, OP_RN},
+    {0x380, 11, handle_sturb, "STURB", CLS_STORE, 1, OP_RT | OP_RN | OP_RN_SP | OP_RN_WB},
+    {0x384, 11, handle_ldurb, "LDURB", CLS_LOAD, 1, OP_RD | OP_RN | OP_RN_SP | OP_RN_WB},
+    {0x780, 11, handle_sturh, "STURH", CLS_STORE, 2, OP_RT | OP_RN | OP_RN_SP | OP_RN_WB},
+    {0x784, 11, handle_ldurh, "LDURH", CLS_LOAD, 2, OP_RD | OP_RN | OP_RN_SP | OP_RN_WB},
+    {0x8B0, 11, handle_add_reg, "ADD (reg)", CLS_ALU, 0, OP_RD | OP_RN | OP_RM},
+    {0x9B0, 11, handle_mul, "MUL", CLS_MUL, 0, OP_RD | OP_RN | OP_RM},
+    {0xF80, 11, handle_stur, "STUR", CLS_STORE, 8, OP_RT | OP_RN | OP_RN_SP | OP_RN_WB},
+    {0xF84, 11, handle_ldur, "LDUR", CLS_LOAD, 8, OP_RD | OP_RN | OP_RN_SP | OP_RN_WB},
+    {0xC84, 11, handle_ldxr, "LDXR", CLS_LOAD, 8, OP_RD | OP_RN | OP_RN_SP},
+    {0xC80, 11, handle_stxr, "STXR", CLS_STORE, 8, OP_RT | OP_RN | OP_RN_SP | OP_RM_W},
+    {0xC8A, 11, handle_cas, "CAS", CLS_LOAD, 8, OP_RT | OP_RN | OP_RN_SP | OP_RM | OP_RM_W},
+    {0xC8E, 11, handle_cas, "CASA", CLS_LOAD, 8, OP_RT | OP_RN | OP_RN_SP | OP_RM | OP_RM_W},
+    {0xF82, 11, handle_ldop, "LDADD/SWP", CLS_LOAD, 8, OP_RD | OP_RN | OP_RN_SP | OP_RM},
+    {0xF86, 11, handle_ldop, "LDADDL/SWPL", CLS_LOAD, 8, OP_RD | OP_RN | OP_RN_SP | OP_RM},
+    {0xF8A, 11, handle_ldop, "LDADDA/SWPA", CLS_LOAD, 8, OP_RD | OP_RN | OP_RN_SP | OP_RM},
+    {0xF8E, 11, handle_ldop, "LDADDAL/SWPAL", CLS_LOAD, 8, OP_RD | OP_RN | OP_RN_SP | OP_RM},
+    {0xD40, 11, handle_svc, "SVC", CLS_SYS, 0, 0},
+    {0xD28, 11, handle_movz, "MOVZ", CLS_ALU, 0, OP_RD},
+    {0xD34, 10, handle_shift, "LSL/LSR", CLS_ALU, 0, OP_RD | OP_RN},
+    {0xA90, 10, handle_stp, "STP", CLS_STORE, 16, OP_RT | OP_RT2 | OP_RN | OP_RN_SP},
+    {0xA98, 10, handle_stp, "STP (pre)", CLS_STORE, 16, OP_RT | OP_RT2 | OP_RN | OP_RN_SP | OP_RN_WB},
+    {0xA88, 10, handle_stp, "STP (post)", CLS_STORE, 16, OP_RT | OP_RT2 | OP_RN | OP_RN_SP | OP_RN_WB},
+    {0xA94, 10, handle_ldp, "LDP", CLS_LOAD, 16, OP_RD | OP_RT2_W | OP_RN | OP_RN_SP},
+    {0xA9C, 10, handle_ldp, "LDP (pre)", CLS_LOAD, 16, OP_RD | OP_RT2_W | OP_RN | OP_RN_SP | OP_RN_WB},
+    {0xA8C, 10, handle_ldp, "LDP (post)", CLS_LOAD, 16, OP_RD | OP_RT2_W | OP_RN | OP_RN_SP | OP_RN_WB},
+    {0x54, 8, handle_b_cond, "B.cond", CLS_COND_BRANCH, 0, OP_FLAGS_R},
+    {0x91, 8, handle_add_imm, "ADD (imm)", CLS_ALU, 0, OP_RD | OP_RD_SP | OP_RN | OP_RN_SP},
+    {0xAA, 8, handle_orr, "ORR", CLS_ALU, 0, OP_RD | OP_RN | OP_RM},
+    {0xAB, 8, handle_adds_reg, "ADDS (reg)", CLS_ALU, 0, OP_RD | OP_RN | OP_RM | OP_FLAGS_W},
+    {0xB1, 8, handle_adds_imm, "ADDS (imm)", CLS_ALU, 0, OP_RD | OP_RN | OP_RN_SP | OP_FLAGS_W},
+    {0xB4, 8, handle_cbz, "CBZ", CLS_COND_BRANCH, 0, OP_RT},
+    {0xB5, 8, handle_cbnz, "CBNZ", CLS_COND_BRANCH, 0, OP_RT},
+    {0xCA, 8, handle_eor, "EOR", CLS_ALU, 0, OP_RD | OP_RN | OP_RM},
+    {0xEA, 8, handle_ands, "ANDS", CLS_ALU, 0, OP_RD | OP_RN | OP_RM | OP_FLAGS_W},
+    {0xEB, 8, handle_subs_reg, "SUBS (reg)", CLS_ALU, 0, OP_RD | OP_RN | OP_RM | OP_FLAGS_W},
+    {0xF1, 8, handle_subs_imm, "SUBS (imm)", CLS_ALU, 0, OP_RD | OP_RN | OP_RN_SP | OP_FLAGS_W},
+    {0xD4, 8, handle_hlt, "HLT", CLS_SYS, 0, 0},
+    {0x14, 6, handle_b, "B", CLS_BRANCH, 0, 0}
+};
+const int OPCODE_COUNT = sizeof(OPCODE_TABLE) / sizeof(OPCODE_TABLE[0]);
 
 HashMap *opcode_map = NULL;
-int branch_taken = 0;
+HART_LOCAL int branch_taken = 0;
 
 // Inicializa el mapa de opcodes usando (longitud, opcode reducido)
 void init_opcode_map() {
     if (opcode_map) return;
     opcode_map = hashmap_create();
-    InstructionEntry entries[] = {
-        {0xD61F00, 22, handle_br},
-        {0x380, 11, handle_sturb},
-        {0x384, 11, handle_ldurb},
-        {0x780, 11, handle_sturh},
-        {0x784, 11, handle_ldurh},
-        {0x8B0, 11, handle_add_reg},
-        {0x9B0, 11, handle_mul},
-        {0xF80, 11, handle_stur},
-        {0xF84, 11, handle_ldur},
-        {0xD28, 11, handle_movz}, 
-        {0xD34, 10, handle_shift},
-        {0x54, 8, handle_b_cond},
-        {0x91, 8, handle_add_imm},
-        {0xAA, 8, handle_orr},
-        {0xAB, 8, handle_adds_reg},
-        {0xB1, 8, handle_adds_imm},
-        {0xB4, 8, handle_cbz},
-        {0xB5, 8, handle_cbnz},
-        {0xCA, 8, handle_eor},
-        {0xEA, 8, handle_ands},
-        {0xEB, 8, handle_subs_reg},
-        {0xF1, 8, handle_subs_imm},
-        {0xD4, 8, handle_hlt},
-        {0x14, 6, handle_b}
-    };
-    int n = sizeof(entries) / sizeof(entries[0]);
-    for (int i = 0; i < n; i++) {
-        uint32_t len = entries[i].length;
-        uint32_t opcode_key = entries[i].pattern;
-        hashmap_put(opcode_map, len, opcode_key, entries[i].handler);
+    for (int i = 0; i < OPCODE_COUNT; i++) {
+        uint32_t len = OPCODE_TABLE[i].length;
+        uint32_t opcode_key = OPCODE_TABLE[i].pattern;
+        hashmap_put(opcode_map, len, opcode_key, (void *)&OPCODE_TABLE[i]);
     }
 }
 
-InstructionHandler decode_instruction(uint32_t instruction) {
+const InstructionEntry *decode_instruction(uint32_t instruction) {
     if (!opcode_map) init_opcode_map();
     static const int lengths[] = {22, 11, 10, 8, 6};
     for (int i = 0; i < sizeof(lengths)/sizeof(lengths[0]); i++) {
         int len = lengths[i];
         uint32_t opcode_key = instruction >> (32 - len);
         opcode_key <<= ((32 - len) % 4);
-        InstructionHandler handler = hashmap_get(opcode_map, len, opcode_key);
-        if (handler)
-            return handler;
+        const InstructionEntry *entry = hashmap_get(opcode_map, len, opcode_key);
+        if (entry)
+            return entry;
     }
     return NULL;
 }
 
 void process_instruction() {
+    PROF_START(t);
     uint32_t instr = mem_read_32(CURRENT_STATE.PC);
-    InstructionHandler handler = decode_instruction(instr);
-    if (handler) {
+    if (cache_enabled) cache_fetch(CURRENT_STATE.PC);
+    PROF_LAP(t, PROF_FETCH);
+    const InstructionEntry *entry = decode_instruction(instr);
+    PROF_LAP(t, PROF_DECODE);
+    if (entry) {
         branch_taken = 0;
-        handler(instr);
+        entry->handler(instr);
         if (!branch_taken) NEXT_STATE.PC += 4;
+        PROF_LAP_HANDLER(t, entry - OPCODE_TABLE);
+        STATS_RECORD(entry - OPCODE_TABLE, branch_taken);
+        if (hotspot_enabled) hotspot_record(CURRENT_STATE.PC, entry->cls >= CLS_BRANCH);
+        if (retire_consumers) retire_instruction(entry, instr);
     } else {
-        printf("Unsupported instruction: 0x%08X\n", instr);
-        exit(1);
+        unsupported_instruction(instr);
     }
 }
+
+// Instruccion sin handler (o con una variante no implementada)
+void unsupported_instruction(uint32_t instr) {
+    if (FAULT_JMP) longjmp(*FAULT_JMP, FAULT_UNSUPPORTED);
+    printf("Unsupported instruction: 0x%08X\n", instr);
+    exit(1);
+}
@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "snapshot.h"
+#include "syscall.h"
+#include "hart.h"
+
+static int page_is_zero(const uint8_t *p, size_t len) {
+    const uint64_t *w = (const uint64_t *)p;
+    for (size_t i = 0; i < len / 8; i++)
+        if (w[i]) return 0;
+    return 1;
+}
+
+// Estado de la ultima marca; la memoria de la marca vive en MEM_REGIONS[].backup
+static HartState *mark_harts;
+static int mark_nharts, mark_current;
+static uint64_t mark_count;
+static uint64_t mark_brk, mark_mmap_top;
+
+#define PAGE_BIT(bitmap, p) ((bitmap)[(p) >> 6] & (1ULL << ((p) & 63)))
+
+uint32_t mem_region_pages(int r) {
+    return (MEM_REGIONS[r].size + MEM_PAGE_SIZE - 1) >> MEM_PAGE_SHIFT;
+}
+
+static size_t page_len(int r, size_t p) {
+    size_t off = p * SNAP_PAGE_SIZE;
+    return MEM_REGIONS[r].size - off < SNAP_PAGE_SIZE ? MEM_REGIONS[r].size - off : SNAP_PAGE_SIZE;
+}
+
+// Llamado desde mem_write_32 antes de la primera escritura a una pagina desde
+// la marca. Con harts en threads dos pueden llegar a la vez: el lock hace que
+// solo uno copie la pagina y que el bit se vea recien con la copia completa.
+static pthread_mutex_t first_write_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void mem_page_first_write(int r, uint32_t p) {
+    mem_region_t *m = &MEM_REGIONS[r];
+    pthread_mutex_lock(&first_write_lock);
+    if (!PAGE_BIT(m->dirty, p)) {
+        memcpy(m->backup + (size_t)p * MEM_PAGE_SIZE, m->mem + (size_t)p * MEM_PAGE_SIZE, page_len(r, p));
+        __atomic_fetch_or(&m->dirty[p >> 6], 1ULL << (p & 63), __ATOMIC_RELEASE);
+        __atomic_fetch_or(&m->touched[p >> 6], 1ULL << (p & 63), __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&first_write_lock);
+}
+
+static void page_modify(int r, uint32_t p) {
+    if (!PAGE_BIT(MEM_REGIONS[r].dirty, p)) mem_page_first_write(r, p);
+}
+
+void snapshot_mark(void) {
+    for (int r = 0; r < MEM_NREGIONS; r++)
+        memset(MEM_REGIONS[r].dirty, 0, (mem_region_pages(r) / 64 + 1) * sizeof(uint64_t));
+    mark_harts = realloc(mark_harts, hart_count * sizeof(HartState));
+    hart_export(mark_harts);
+    mark_nharts = hart_count;
+    mark_current = hart_current();
+    mark_count = INSTRUCTION_COUNT;
+    mark_brk = guest_brk;
+    mark_mmap_top = guest_mmap_top;
+}
+
+// Restaura la marca copiando solo las paginas sucias; devuelve cuantas fueron
+uint64_t snapshot_reset(void) {
+    uint64_t restored = 0;
+    for (int r = 0; r < MEM_NREGIONS; r++) {
+        mem_region_t *m = &MEM_REGIONS[r];
+        for (uint32_t w = 0; w <= mem_region_pages(r) / 64; w++) {
+            while (m->dirty[w]) {
+                uint32_t p = w * 64 + __builtin_ctzll(m->dirty[w]);
+                memcpy(m->mem + (size_t)p * MEM_PAGE_SIZE, m->backup + (size_t)p * MEM_PAGE_SIZE, page_len(r, p));
+                m->dirty[w] &= m->dirty[w] - 1;
+                restored++;
+            }
+        }
+    }
+    if (mark_harts) hart_import(mark_nharts, mark_current, mark_harts);
+    INSTRUCTION_COUNT = mark_count;
+    guest_brk = mark_brk;
+    guest_mmap_top = mark_mmap_top;
+    return restored;
+}
+
+int snapshot_save(const char *path) {
+    SnapshotHeader h;
+    uint32_t *index = NULL;
+    static const uint8_t zeros[SNAP_PAGE_SIZE];
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAP_MAGIC, sizeof(SNAP_MAGIC));
+    h.version = SNAP_VERSION;
+    h.page_size = SNAP_PAGE_SIZE;
+    h.nharts = hart_count;
+    h.current_hart = hart_current();
+    h.instruction_count = INSTRUCTION_COUNT;
+    h.brk = guest_brk;
+    h.mmap_top = guest_mmap_top;
+    h.nregions = MEM_NREGIONS;
+
+    for (int r = 0; r < MEM_NREGIONS; r++) {
+        h.regions[r].start = MEM_REGIONS[r].start;
+        h.regions[r].size = MEM_REGIONS[r].size;
+        h.regions[r].first = h.npages;
+        for (uint32_t p = 0; p < mem_region_pages(r); p++) {
+            if (!PAGE_BIT(MEM_REGIONS[r].touched, p)) continue;
+            if (page_is_zero(MEM_REGIONS[r].mem + p * SNAP_PAGE_SIZE, page_len(r, p))) continue;
+            index = realloc(index, (h.npages + 1) * sizeof(uint32_t));
+            index[h.npages++] = p;
+        }
+        h.regions[r].npages = h.npages - h.regions[r].first;
+    }
+    size_t meta = sizeof(h) + h.nharts * sizeof(HartState) + h.npages * sizeof(uint32_t);
+    h.data_offset = (meta + SNAP_PAGE_SIZE - 1) / SNAP_PAGE_SIZE * SNAP_PAGE_SIZE;
+
+    HartState *states = malloc(h.nharts * sizeof(HartState));
+    hart_export(states);
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        free(states);
+        free(index);
+        return -1;
+    }
+    fwrite(&h, sizeof(h), 1, f);
+    fwrite(states, sizeof(HartState), h.nharts, f);
+    fwrite(index, sizeof(uint32_t), h.npages, f);
+    fwrite(zeros, 1, h.data_offset - meta, f);
+    for (int r = 0; r < MEM_NREGIONS; r++) {
+        for (uint32_t k = 0; k < h.regions[r].npages; k++) {
+            uint32_t p = index[h.regions[r].first + k];
+            size_t len = page_len(r, p);
+            fwrite(MEM_REGIONS[r].mem + (size_t)p * SNAP_PAGE_SIZE, 1, len, f);
+            fwrite(zeros, 1, SNAP_PAGE_SIZE - len, f);
+        }
+    }
+    free(states);
+    free(index);
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+// Devuelve -1 si el archivo no existe o no corresponde a este layout de memoria
+int snapshot_load(const char *path) {
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader)) {
+        close(fd);
+        return -1;
+    }
+    uint8_t *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    const SnapshotHeader *h = (const SnapshotHeader *)map;
+    const HartState *states = (const HartState *)(map + sizeof(SnapshotHeader));
+    const uint32_t *index = (const uint32_t *)(states + h->nharts);
+    int ok = memcmp(h->magic, SNAP_MAGIC, sizeof(SNAP_MAGIC)) == 0 && h->version == SNAP_VERSION
+        && h->page_size == SNAP_PAGE_SIZE && h->nregions == MEM_NREGIONS
+        && h->nharts >= 1 && h->nharts <= HART_MAX && h->current_hart < h->nharts
+        && GUEST_HEAP_START <= h->brk && h->brk <= h->mmap_top && h->mmap_top <= GUEST_HEAP_END
+        && sizeof(SnapshotHeader) + (uint64_t)h->nharts * sizeof(HartState)
+               + (uint64_t)h->npages * sizeof(uint32_t) <= h->data_offset
+        && h->data_offset <= (uint64_t)st.st_size
+        && (uint64_t)h->npages * SNAP_PAGE_SIZE <= (uint64_t)st.st_size - h->data_offset;
+    // Todo se valida antes de tocar la memoria o los harts
+    for (int r = 0; ok && r < MEM_NREGIONS; r++) {
+        ok = h->regions[r].start == MEM_REGIONS[r].start && h->regions[r].size == MEM_REGIONS[r].size
+            && (uint64_t)h->regions[r].first + h->regions[r].npages <= h->npages;
+        for (uint32_t k = 0; ok && k < h->regions[r].npages; k++)
+            ok = index[h->regions[r].first + k] < mem_region_pages(r);
+    }
+    if (!ok) {
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    // Solo se limpian las paginas escritas alguna vez; pasan por el mismo
+    // camino que mem_write_32 para que reset siga restaurando la marca
+    for (int r = 0; r < MEM_NREGIONS; r++) {
+        mem_region_t *m = &MEM_REGIONS[r];
+        for (uint32_t p = 0; p < mem_region_pages(r); p++) {
+            if (!PAGE_BIT(m->touched, p)) continue;
+            page_modify(r, p);
+            memset(m->mem + (size_t)p * MEM_PAGE_SIZE, 0, page_len(r, p));
+        }
+        for (uint32_t k = 0; k < h->regions[r].npages; k++) {
+            uint32_t slot = h->regions[r].first + k, p = index[slot];
+            page_modify(r, p);
+            memcpy(MEM_REGIONS[r].mem + (size_t)p * SNAP_PAGE_SIZE,
+                   map + h->data_offset + (size_t)slot * SNAP_PAGE_SIZE, page_len(r, p));
+        }
+    }
+    hart_import(h->nharts, h->current_hart, states);
+    INSTRUCTION_COUNT = h->instruction_count;
+    guest_brk = h->brk;
+    guest_mmap_top = h->mmap_top;
+    munmap(map, st.st_size);
+    return 0;
+}
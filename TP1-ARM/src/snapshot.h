@@ -0,0 +1,41 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+#include "shell.h"
+
+// Snapshot del estado completo del simulador. El archivo es un encabezado,
+// el estado de cada hart, el indice de paginas guardadas y las paginas no
+// nulas de cada region,
+// alineadas a SNAP_PAGE_SIZE para poder mapearlo directamente.
+#define SNAP_MAGIC "ARMSNAP"
+#define SNAP_VERSION 4
+#define SNAP_PAGE_SIZE MEM_PAGE_SIZE
+
+typedef struct {
+    uint64_t start, size;
+    uint32_t first, npages;     // rango en el indice de paginas
+} SnapshotRegion;
+
+typedef struct {
+    char magic[8];
+    uint32_t version, page_size;
+    uint32_t nharts, current_hart;  // siguen nharts HartState (hart.h)
+    uint64_t instruction_count;
+    uint64_t brk, mmap_top;     // heap del guest (syscall.c)
+    uint32_t nregions, npages;
+    uint64_t data_offset;       // primera pagina, multiplo de page_size
+    SnapshotRegion regions[MEM_NREGIONS];
+} SnapshotHeader;
+
+int snapshot_save(const char *path);
+int snapshot_load(const char *path);
+
+// Marca y reset incremental: las paginas se copian a MEM_REGIONS[].backup la
+// primera vez que se escriben despues de la marca, y reset solo restaura esas.
+void snapshot_mark(void);
+uint64_t snapshot_reset(void);
+void mem_page_first_write(int region, uint32_t page);
+uint32_t mem_region_pages(int region);
+
+#endif
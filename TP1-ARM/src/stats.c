@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "stats.h"
+#include "handlers.h"
+
+uint64_t stats_count[MAX_OPCODES];
+uint64_t stats_taken[MAX_OPCODES];
+int stats_summary = 0;
+
+typedef struct {
+    uint64_t total, blocks;
+    uint64_t loads[17], stores[17];   // indexado por ancho en bytes
+    uint64_t cond, cond_taken;
+} StatsTotals;
+
+static void compute_totals(StatsTotals *t) {
+    memset(t, 0, sizeof(*t));
+    for (int i = 0; i < OPCODE_COUNT; i++) {
+        const InstructionEntry *e = &OPCODE_TABLE[i];
+        t->total += stats_count[i];
+        if (e->cls >= CLS_BRANCH) t->blocks += stats_count[i];
+        if (e->cls == CLS_LOAD) t->loads[e->width] += stats_count[i];
+        if (e->cls == CLS_STORE) t->stores[e->width] += stats_count[i];
+        if (e->cls == CLS_COND_BRANCH) {
+            t->cond += stats_count[i];
+            t->cond_taken += stats_taken[i];
+        }
+    }
+}
+
+void stats_report(FILE *out) {
+    StatsTotals t;
+    compute_totals(&t);
+
+    fprintf(out, "\nDynamic instruction mix (%" PRIu64 " instructions):\n", t.total);
+    fprintf(out, "-------------------------------------\n");
+    for (int i = 0; i < OPCODE_COUNT; i++) {
+        if (!stats_count[i]) continue;
+        fprintf(out, "%-12s %14" PRIu64 " %6.2f%%", OPCODE_TABLE[i].name, stats_count[i],
+                100.0 * stats_count[i] / t.total);
+        if (OPCODE_TABLE[i].cls == CLS_COND_BRANCH)
+            fprintf(out, "  taken %" PRIu64 " / not taken %" PRIu64,
+                    stats_taken[i], stats_count[i] - stats_taken[i]);
+        fprintf(out, "\n");
+    }
+    fprintf(out, "Loads  (8/16/64 bit, pair) : %" PRIu64 " / %" PRIu64 " / %" PRIu64 " / %" PRIu64 "\n",
+            t.loads[1], t.loads[2], t.loads[8], t.loads[16]);
+    fprintf(out, "Stores (8/16/64 bit, pair) : %" PRIu64 " / %" PRIu64 " / %" PRIu64 " / %" PRIu64 "\n",
+            t.stores[1], t.stores[2], t.stores[8], t.stores[16]);
+    fprintf(out, "Branch taken ratio   : %.2f%%\n", t.cond ? 100.0 * t.cond_taken / t.cond : 0.0);
+    fprintf(out, "Avg basic block      : %.2f instructions\n\n",
+            t.blocks ? (double)t.total / t.blocks : 0.0);
+}
+
+int stats_export_csv(const char *path) {
+    StatsTotals t;
+    FILE *out = fopen(path, "w");
+    if (!out) return -1;
+    compute_totals(&t);
+
+    fprintf(out, "kind,name,count,taken,not_taken\n");
+    for (int i = 0; i < OPCODE_COUNT; i++) {
+        int cond = OPCODE_TABLE[i].cls == CLS_COND_BRANCH;
+        fprintf(out, "handler,%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n", OPCODE_TABLE[i].name,
+                stats_count[i], cond ? stats_taken[i] : 0, cond ? stats_count[i] - stats_taken[i] : 0);
+    }
+    for (int w = 1; w <= 16; w *= 2) {
+        if (w == 4) continue;
+        fprintf(out, "load,%d,%" PRIu64 ",0,0\n", w * 8, t.loads[w]);
+        fprintf(out, "store,%d,%" PRIu64 ",0,0\n", w * 8, t.stores[w]);
+    }
+    fprintf(out, "summary,instructions,%" PRIu64 ",0,0\n", t.total);
+    fprintf(out, "summary,cond_branches,%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+            t.cond, t.cond_taken, t.cond - t.cond_taken);
+    fprintf(out, "summary,basic_blocks,%" PRIu64 ",0,0\n", t.blocks);
+    fclose(out);
+    return 0;
+}
+
+void stats_reset(void) {
+    memset(stats_count, 0, sizeof(stats_count));
+    memset(stats_taken, 0, sizeof(stats_taken));
+}
@@ -0,0 +1,18 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Contadores dinamicos por handler, incrementados en process_instruction
+extern uint64_t stats_count[];
+extern uint64_t stats_taken[];
+extern int stats_summary;
+
+#define STATS_RECORD(id, taken) do { stats_count[id]++; stats_taken[id] += (taken); } while (0)
+
+void stats_report(FILE *out);
+int stats_export_csv(const char *path);
+void stats_reset(void);
+
+#endif
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "syscall.h"
+#include "device.h"
+
+#define MAP_ANONYMOUS_ARM64 0x20
+
+uint64_t guest_brk = GUEST_HEAP_START;
+uint64_t guest_mmap_top = GUEST_HEAP_END;
+
+// brk y mmap son del proceso, no del hart: con harts en threads se serializan
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// El guest solo ve stdin, stdout y stderr; cualquier otro fd del host es del
+// simulador (dumpsim, trazas, snapshots) y no se le pasa
+static int guest_fd_ok(int64_t fd) {
+    return fd >= 0 && fd <= 2;
+}
+
+static int64_t sys_write(int64_t fd, uint64_t buf, uint64_t count) {
+    if (!guest_fd_ok(fd)) return -EBADF;
+    if (count == 0) return 0;
+    uint8_t *p = mem_host_ptr(buf, count, 0);
+    if (!p) return -EFAULT;
+    // Lo que imprimieron el shell y la UART tiene que salir antes
+    device_flush_all();
+    fflush(stdout);
+    ssize_t n = write(fd, p, count);
+    return n < 0 ? -errno : n;
+}
+
+static int64_t sys_read(int64_t fd, uint64_t buf, uint64_t count) {
+    if (!guest_fd_ok(fd)) return -EBADF;
+    if (count == 0) return 0;
+    uint8_t *p = mem_host_ptr(buf, count, 1);
+    if (!p) return -EFAULT;
+    ssize_t n = read(fd, p, count);
+    return n < 0 ? -errno : n;
+}
+
+// brk(0) o una direccion fuera del heap devuelven el break actual, como Linux
+static int64_t sys_brk(uint64_t addr) {
+    pthread_mutex_lock(&heap_lock);
+    if (addr >= GUEST_HEAP_START && addr <= guest_mmap_top) {
+        // Sin fallar con el lock tomado; si no hay memoria el break no se mueve
+        uint8_t *p = addr > guest_brk ? mem_region_ptr(guest_brk, addr - guest_brk, 1) : NULL;
+        if (p) memset(p, 0, addr - guest_brk);
+        if (p || addr <= guest_brk) guest_brk = addr;
+    }
+    addr = guest_brk;
+    pthread_mutex_unlock(&heap_lock);
+    return addr;
+}
+
+// Solo mapeos anonimos (en cero): sin openat el guest no tiene archivos que
+// mapear. La direccion pedida se ignora y las paginas no se liberan.
+static int64_t sys_mmap(uint64_t len, uint64_t flags) {
+    uint64_t size = (len + MEM_PAGE_SIZE - 1) & ~(uint64_t)(MEM_PAGE_SIZE - 1);
+    uint64_t addr;
+    uint8_t *p;
+
+    if (!(flags & MAP_ANONYMOUS_ARM64)) return -EBADF;
+    if (len == 0) return -EINVAL;
+    if (size < len) return -ENOMEM;
+    pthread_mutex_lock(&heap_lock);
+    addr = guest_mmap_top - size;
+    p = size <= guest_mmap_top - guest_brk ? mem_region_ptr(addr, size, 1) : NULL;
+    if (p) guest_mmap_top = addr;
+    pthread_mutex_unlock(&heap_lock);
+    if (!p) return -ENOMEM;
+    memset(p, 0, size);
+    return addr;
+}
+
+static int64_t sys_clock_gettime(int clock, uint64_t tp) {
+    struct timespec ts;
+    uint64_t out[2];
+    uint8_t *p = mem_host_ptr(tp, sizeof(out), 1);
+    if (!p) return -EFAULT;
+    if (clock_gettime(clock, &ts) != 0) return -errno;
+    out[0] = ts.tv_sec;
+    out[1] = ts.tv_nsec;
+    memcpy(p, out, sizeof(out));
+    return 0;
+}
+
+void syscall_dispatch(void) {
+    int64_t *x = CURRENT_STATE.REGS;
+    int64_t ret;
+
+    switch (x[8]) {
+    case SYS_WRITE:         ret = sys_write(x[0], x[1], x[2]); break;
+    case SYS_READ:          ret = sys_read(x[0], x[1], x[2]); break;
+    case SYS_BRK:           ret = sys_brk(x[0]); break;
+    case SYS_MMAP:          ret = sys_mmap(x[1], x[3]); break;
+    case SYS_CLOCK_GETTIME: ret = sys_clock_gettime(x[0], x[1]); break;
+    case SYS_EXIT:
+    case SYS_EXIT_GROUP:
+        RUN_BIT = 0;
+        device_flush_all();
+        return;
+    default:
+        ret = -ENOSYS;
+    }
+    NEXT_STATE.REGS[0] = ret;
+}
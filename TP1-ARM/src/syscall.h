@@ -0,0 +1,29 @@
+#ifndef SYSCALL_H
+#define SYSCALL_H
+
+#include <stdint.h>
+#include "shell.h"
+
+// Emulacion de syscalls de Linux AArch64 para SVC #0: numero en X8,
+// argumentos en X0-X5 y resultado (o -errno) en X0. Los buffers del guest
+// se pasan directo a read/write del host, sin copias intermedias; solo los
+// fds 0-2.
+#define SYS_READ          63
+#define SYS_WRITE         64
+#define SYS_EXIT          93
+#define SYS_EXIT_GROUP    94
+#define SYS_CLOCK_GETTIME 113
+#define SYS_BRK           214
+#define SYS_MMAP          222
+
+// Heap del guest: brk crece desde la mitad de la region de datos hacia
+// arriba y mmap (solo anonimo) reserva paginas desde el final hacia abajo.
+#define GUEST_HEAP_START (MEM_DATA_START + MEM_DATA_SIZE / 2)
+#define GUEST_HEAP_END   (MEM_DATA_START + MEM_DATA_SIZE)
+
+extern uint64_t guest_brk;
+extern uint64_t guest_mmap_top;
+
+void syscall_dispatch(void);
+
+#endif
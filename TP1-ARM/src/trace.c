@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include "trace.h"
+#include "trace_read.h"
+#include "shell.h"
+
+#define TRACE_CHUNKS 8
+#define TRACE_CHUNK_SIZE (256 * 1024)
+#define TRACE_MAX_RECORD 64     // cota de un registro codificado
+#define ENC_SLOTS (MEM_TEXT_SIZE / 4)
+
+static FILE *trace_file = NULL;
+static char trace_path[256];
+
+// Anillo de bloques: el simulador llena chunks[head], el writer vacia chunks[tail]
+static uint8_t chunks[TRACE_CHUNKS][TRACE_CHUNK_SIZE];
+static size_t chunk_len[TRACE_CHUNKS];
+static unsigned head, tail, full;
+static size_t pos;
+static int stopping;
+static pthread_t writer;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t filled = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t drained = PTHREAD_COND_INITIALIZER;
+
+// Estado del codificador, espejo del de trace_read.c
+static uint64_t last_pc, last_addr;
+static uint64_t last_regs[64];
+static uint32_t *enc_seen = NULL;
+static uint8_t *enc_valid = NULL;
+static uint64_t records, bytes, producer_waits;
+
+static void *writer_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&lock);
+    for (;;) {
+        while (full == 0 && !stopping)
+            pthread_cond_wait(&filled, &lock);
+        if (full == 0) break;
+        unsigned idx = tail % TRACE_CHUNKS;
+        pthread_mutex_unlock(&lock);
+        fwrite(chunks[idx], 1, chunk_len[idx], trace_file);
+        pthread_mutex_lock(&lock);
+        tail++;
+        full--;
+        pthread_cond_signal(&drained);
+    }
+    pthread_mutex_unlock(&lock);
+    return NULL;
+}
+
+// Entrega el bloque actual al writer; espera si el anillo esta lleno
+static void submit_chunk(void) {
+    pthread_mutex_lock(&lock);
+    chunk_len[head % TRACE_CHUNKS] = pos;
+    bytes += pos;
+    head++;
+    full++;
+    pthread_cond_signal(&filled);
+    if (full == TRACE_CHUNKS) producer_waits++;
+    while (full == TRACE_CHUNKS)
+        pthread_cond_wait(&drained, &lock);
+    pthread_mutex_unlock(&lock);
+    pos = 0;
+}
+
+static inline void put_varint(uint8_t *buf, uint64_t v) {
+    while (v >= 0x80) {
+        buf[pos++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    buf[pos++] = (uint8_t)v;
+}
+
+static inline uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+void trace_retire(const RetireInfo *r) {
+    uint8_t *buf = chunks[head % TRACE_CHUNKS];
+    size_t start = pos++;
+    uint8_t flags = 0;
+
+    if (r->pc != last_pc + 4) {
+        flags |= TR_JUMP;
+        put_varint(buf, zigzag(r->pc - (last_pc + 4)));
+    }
+    last_pc = r->pc;
+
+    uint64_t idx = (r->pc - MEM_TEXT_START) >> 2;
+    if (idx >= ENC_SLOTS || !enc_valid[idx] || enc_seen[idx] != r->instr) {
+        flags |= TR_ENC;
+        for (int i = 0; i < 4; i++) buf[pos++] = r->instr >> (8 * i);
+        if (idx < ENC_SLOTS) {
+            enc_seen[idx] = r->instr;
+            enc_valid[idx] = 1;
+        }
+    }
+
+    // Primer destino que no sea flags; los flags se reconstruyen del programa
+    for (int i = 0; i < r->ndst; i++) {
+        uint8_t d = r->dst[i];
+        if (d == REG_FLAGS) continue;
+        uint64_t v = NEXT_STATE.REGS[d];
+        flags |= TR_DST;
+        buf[pos++] = d;
+        put_varint(buf, zigzag(v - last_regs[d]));
+        last_regs[d] = v;
+        break;
+    }
+
+    if (r->cls == CLS_LOAD || r->cls == CLS_STORE) {
+        int width = OPCODE_TABLE[r->id].width;
+        flags |= TR_MEM | (r->cls == CLS_STORE ? TR_STORE : 0);
+        // Los pares (LDP/STP) se registran como acceso de 8 bytes a la primera direccion
+        flags |= (width >= 8 ? 3 : width == 4 ? 2 : width == 2 ? 1 : 0) << TR_SIZE_SHIFT;
+        put_varint(buf, zigzag(r->addr - last_addr));
+        put_varint(buf, r->data);
+        last_addr = r->addr;
+    }
+
+    buf[start] = flags;
+    records++;
+    if (pos > TRACE_CHUNK_SIZE - TRACE_MAX_RECORD) submit_chunk();
+}
+
+int trace_start(const char *path) {
+    static int registered = 0;
+    TraceHeader h;
+
+    trace_stop();
+    if (!(trace_file = fopen(path, "wb"))) return -1;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    h.version = TRACE_VERSION;
+    h.text_start = MEM_TEXT_START;
+    h.text_size = MEM_TEXT_SIZE;
+    fwrite(&h, sizeof(h), 1, trace_file);
+
+    if (!enc_seen) {
+        enc_seen = malloc(ENC_SLOTS * sizeof(uint32_t));
+        enc_valid = malloc(ENC_SLOTS);
+    }
+    memset(enc_valid, 0, ENC_SLOTS);
+    memset(last_regs, 0, sizeof(last_regs));
+    last_pc = MEM_TEXT_START - 4;
+    last_addr = 0;
+    head = tail = full = 0;
+    pos = 0;
+    stopping = 0;
+    records = bytes = producer_waits = 0;
+    snprintf(trace_path, sizeof(trace_path), "%s", path);
+    pthread_create(&writer, NULL, writer_main, NULL);
+    if (!registered) {
+        atexit(trace_stop);
+        registered = 1;
+    }
+    retire_consumers |= RETIRE_TRACE;
+    return 0;
+}
+
+// Vacia el bloque parcial, espera al writer y cierra el archivo
+void trace_stop(void) {
+    if (!trace_file) return;
+    retire_consumers &= ~RETIRE_TRACE;
+    if (pos) submit_chunk();
+    pthread_mutex_lock(&lock);
+    stopping = 1;
+    pthread_cond_signal(&filled);
+    pthread_mutex_unlock(&lock);
+    pthread_join(writer, NULL);
+    fclose(trace_file);
+    trace_file = NULL;
+}
+
+void trace_status(FILE *out) {
+    if (trace_file)
+        fprintf(out, "Tracing to %s\n", trace_path);
+    else
+        fprintf(out, "Tracing is off\n");
+    fprintf(out, "Records %" PRIu64 ", %" PRIu64 " bytes (%.2f bytes/instr), writer stalls %" PRIu64 "\n\n",
+            records, bytes + pos, records ? (double)(bytes + pos) / records : 0.0, producer_waits);
+}
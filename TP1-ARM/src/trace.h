@@ -0,0 +1,15 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include "retire.h"
+
+// Grabador de trazas binarias (ver trace_read.h para el formato). Los
+// registros se codifican en bloques de un anillo que un thread aparte
+// escribe a disco. Solo con un hart: los registros no llevan el id.
+int trace_start(const char *path);
+void trace_stop(void);
+void trace_retire(const RetireInfo *r);
+void trace_status(FILE *out);
+
+#endif
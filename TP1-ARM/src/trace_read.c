@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace_read.h"
+
+static int read_varint(FILE *f, uint64_t *v) {
+    uint64_t x = 0;
+    int shift = 0, c;
+    do {
+        if ((c = getc(f)) == EOF || shift > 63) return -1;
+        x |= (uint64_t)(c & 0x7F) << shift;
+        shift += 7;
+    } while (c & 0x80);
+    *v = x;
+    return 0;
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+TraceReader *trace_open(const char *path) {
+    TraceReader *tr = calloc(1, sizeof(TraceReader));
+    if (!tr || !(tr->f = fopen(path, "rb"))) {
+        free(tr);
+        return NULL;
+    }
+    if (fread(&tr->header, sizeof(TraceHeader), 1, tr->f) != 1
+        || memcmp(tr->header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0
+        || tr->header.version != TRACE_VERSION) {
+        fclose(tr->f);
+        free(tr);
+        return NULL;
+    }
+    tr->enc = calloc(tr->header.text_size / 4, sizeof(uint32_t));
+    tr->pc = tr->header.text_start - 4;
+    return tr;
+}
+
+// Devuelve 1 si leyo un registro, 0 al final de la traza y -1 si esta truncada
+int trace_next(TraceReader *tr, TraceRecord *rec) {
+    uint64_t v;
+    int flags = getc(tr->f);
+    if (flags == EOF) return 0;
+
+    memset(rec, 0, sizeof(*rec));
+    tr->pc += 4;
+    if (flags & TR_JUMP) {
+        if (read_varint(tr->f, &v)) return -1;
+        tr->pc += unzigzag(v);
+    }
+    rec->pc = tr->pc;
+
+    uint64_t idx = (tr->pc - tr->header.text_start) >> 2;
+    if (flags & TR_ENC) {
+        uint8_t b[4];
+        if (fread(b, 1, 4, tr->f) != 4) return -1;
+        rec->instr = b[0] | b[1] << 8 | b[2] << 16 | (uint32_t)b[3] << 24;
+        if (idx < tr->header.text_size / 4) tr->enc[idx] = rec->instr;
+    } else if (idx < tr->header.text_size / 4) {
+        rec->instr = tr->enc[idx];
+    }
+
+    if (flags & TR_DST) {
+        int reg = getc(tr->f);
+        if (reg == EOF || read_varint(tr->f, &v)) return -1;
+        rec->has_dst = 1;
+        rec->dst = reg & 0x3F;
+        tr->regs[rec->dst] += unzigzag(v);
+        rec->dst_value = tr->regs[rec->dst];
+    }
+    if (flags & TR_MEM) {
+        if (read_varint(tr->f, &v)) return -1;
+        tr->addr += unzigzag(v);
+        if (read_varint(tr->f, &rec->value)) return -1;
+        rec->has_mem = 1;
+        rec->is_store = (flags & TR_STORE) != 0;
+        rec->size = 1 << ((flags >> TR_SIZE_SHIFT) & 3);
+        rec->addr = tr->addr;
+    }
+    tr->records++;
+    return 1;
+}
+
+void trace_close(TraceReader *tr) {
+    if (!tr) return;
+    fclose(tr->f);
+    free(tr->enc);
+    free(tr);
+}
@@ -0,0 +1,52 @@
+#ifndef TRACE_READ_H
+#define TRACE_READ_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Formato de las trazas binarias: encabezado y un registro por instruccion
+// retirada. Cada registro empieza con un byte de flags; el resto son varints
+// (LEB128) con deltas en zigzag respecto del registro anterior.
+#define TRACE_MAGIC "ARMTRC1"
+#define TRACE_VERSION 1
+
+enum {
+    TR_JUMP = 1 << 0,           // delta de PC respecto de pc + 4
+    TR_ENC = 1 << 1,            // encoding nuevo para este PC (4 bytes)
+    TR_DST = 1 << 2,            // registro destino y delta de su valor
+    TR_MEM = 1 << 3,            // delta de direccion y valor accedido
+    TR_STORE = 1 << 4,
+    TR_SIZE_SHIFT = 5,          // log2 del tamano del acceso (bits 6:5)
+};
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t text_start, text_size;
+} TraceHeader;
+
+typedef struct {
+    uint64_t pc;
+    uint32_t instr;
+    int has_dst, has_mem, is_store;
+    uint8_t dst;                // 0-30 X, 32 SP, 34 flags
+    uint64_t dst_value;
+    uint8_t size;
+    uint64_t addr, value;
+} TraceRecord;
+
+typedef struct {
+    FILE *f;
+    TraceHeader header;
+    uint64_t pc, addr;
+    uint64_t regs[64];
+    uint32_t *enc;              // encoding ya visto por PC
+    uint64_t records;
+} TraceReader;
+
+TraceReader *trace_open(const char *path);
+int trace_next(TraceReader *tr, TraceRecord *rec);
+void trace_close(TraceReader *tr);
+
+#endif
@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "trace_read.h"
+
+// Analisis offline de los accesos a memoria de una traza (LDUR*/STUR*):
+// histograma de reuse distance por linea, working set por ventana de
+// instrucciones y strides por PC de load.
+
+#define RD_BUCKETS 40           // log2 de la distancia; el ultimo es "nunca reusado"
+
+typedef struct {
+    uint64_t key, value;        // key 0 = vacio, se guarda key + 1
+} Slot;
+
+typedef struct {
+    Slot *slots;
+    uint64_t cap, len;
+} Table;
+
+typedef struct {
+    uint64_t count, last_addr;
+    int64_t last_stride, candidate;
+    uint64_t same, votes;
+} LoadPC;
+
+static uint64_t *slot_get(Table *t, uint64_t key);
+
+static void table_grow(Table *t) {
+    Table old = *t;
+    t->cap = old.cap ? old.cap * 2 : 1 << 16;
+    t->slots = calloc(t->cap, sizeof(Slot));
+    t->len = 0;
+    for (uint64_t i = 0; i < old.cap; i++)
+        if (old.slots[i].key) *slot_get(t, old.slots[i].key - 1) = old.slots[i].value;
+    free(old.slots);
+}
+
+// Devuelve el valor asociado a key, creandolo en 0 si no existe
+static uint64_t *slot_get(Table *t, uint64_t key) {
+    if (2 * (t->len + 1) > t->cap) table_grow(t);
+    uint64_t i = (key * 0x9E3779B97F4A7C15ULL) & (t->cap - 1);
+    while (t->slots[i].key && t->slots[i].key != key + 1)
+        i = (i + 1) & (t->cap - 1);
+    if (!t->slots[i].key) {
+        t->slots[i].key = key + 1;
+        t->slots[i].value = 0;
+        t->len++;
+    }
+    return &t->slots[i].value;
+}
+
+// Fenwick tree sobre los tiempos de acceso: marca 1 en el ultimo acceso de
+// cada linea, asi la suma en (t_prev, t] es la cantidad de lineas distintas.
+static uint32_t *fenwick = NULL;
+static uint8_t *marks = NULL;
+static uint64_t fenwick_cap = 0;
+
+static void fenwick_add(uint64_t i, int delta) {
+    for (i++; i <= fenwick_cap; i += i & -i) fenwick[i - 1] += delta;
+}
+
+static uint64_t fenwick_prefix(uint64_t i) {      // suma de [0, i)
+    uint64_t s = 0;
+    for (; i > 0; i -= i & -i) s += fenwick[i - 1];
+    return s;
+}
+
+static void fenwick_reserve(uint64_t n) {
+    if (n <= fenwick_cap) return;
+    uint64_t cap = fenwick_cap ? fenwick_cap : 1 << 20;
+    while (cap < n) cap *= 2;
+    marks = realloc(marks, cap);
+    memset(marks + fenwick_cap, 0, cap - fenwick_cap);
+    free(fenwick);
+    fenwick = calloc(cap, sizeof(uint32_t));
+    fenwick_cap = cap;
+    // Reconstruccion en O(n) a partir de las marcas
+    for (uint64_t i = 0; i < cap; i++) {
+        fenwick[i] += marks[i];
+        uint64_t parent = i + ((i + 1) & -(i + 1));
+        if (parent < cap) fenwick[parent] += fenwick[i];
+    }
+}
+
+static int log2_bucket(uint64_t d) {
+    int b = 0;
+    while (d) { b++; d >>= 1; }
+    return b < RD_BUCKETS - 1 ? b : RD_BUCKETS - 2;
+}
+
+static LoadPC *load_pcs;
+static int by_count_desc(const void *a, const void *b) {
+    uint64_t ca = load_pcs[*(const uint32_t *)a].count, cb = load_pcs[*(const uint32_t *)b].count;
+    return (ca < cb) - (ca > cb);
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t line = 64, window = 1000000, top = 10;
+    const char *path = NULL;
+    TraceRecord rec;
+    int r;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) line = strtoull(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) window = strtoull(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) top = strtoull(argv[++i], NULL, 0);
+        else path = argv[i];
+    }
+    if (!path || !line || (line & (line - 1)) || !window) {
+        printf("Usage: %s <trace> [-l line_bytes] [-w window_instrs] [-t top]\n", argv[0]);
+        return 1;
+    }
+    TraceReader *tr = trace_open(path);
+    if (!tr) {
+        printf("Error: %s is not a trace file\n", path);
+        return 1;
+    }
+    int line_bits = __builtin_ctzll(line);
+    uint64_t text_slots = tr->header.text_size / 4;
+    load_pcs = calloc(text_slots, sizeof(LoadPC));
+
+    Table last_use = {0}, footprint_pages = {0}, window_lines = {0}, window_pages = {0};
+    uint64_t hist[RD_BUCKETS] = {0};
+    uint64_t accesses = 0, loads = 0, stores = 0, next_window = window, windows = 0;
+    uint64_t ws_max_lines = 0, ws_sum_lines = 0, ws_max_pages = 0;
+
+    printf("Working set per %" PRIu64 " instructions (%" PRIu64 "B lines / 4 KiB pages):\n", window, line);
+    while ((r = trace_next(tr, &rec)) == 1) {
+        if (tr->records > next_window) {
+            printf("  %12" PRIu64 "  lines %8" PRIu64 "  (%8" PRIu64 " KiB)  pages %6" PRIu64 "\n",
+                   next_window - window, window_lines.len, (window_lines.len << line_bits) / 1024, window_pages.len);
+            if (window_lines.len > ws_max_lines) ws_max_lines = window_lines.len;
+            if (window_pages.len > ws_max_pages) ws_max_pages = window_pages.len;
+            ws_sum_lines += window_lines.len;
+            windows++;
+            free(window_lines.slots);
+            free(window_pages.slots);
+            memset(&window_lines, 0, sizeof(Table));
+            memset(&window_pages, 0, sizeof(Table));
+            next_window += window;
+        }
+        if (!rec.has_mem) continue;
+
+        uint64_t ln = rec.addr >> line_bits;
+        uint64_t now = accesses++;
+        fenwick_reserve(accesses);
+        uint64_t *prev = slot_get(&last_use, ln);
+        if (*prev) {
+            uint64_t t = *prev - 1;
+            hist[log2_bucket(fenwick_prefix(now) - fenwick_prefix(t + 1))]++;
+            marks[t] = 0;
+            fenwick_add(t, -1);
+        } else {
+            hist[RD_BUCKETS - 1]++;
+        }
+        *prev = now + 1;
+        marks[now] = 1;
+        fenwick_add(now, 1);
+
+        *slot_get(&window_lines, ln) = 1;
+        *slot_get(&window_pages, rec.addr >> 12) = 1;
+        *slot_get(&footprint_pages, rec.addr >> 12) = 1;
+
+        if (rec.is_store) { stores++; continue; }
+        loads++;
+        uint64_t idx = (rec.pc - tr->header.text_start) >> 2;
+        if (idx >= text_slots) continue;
+        LoadPC *p = &load_pcs[idx];
+        if (p->count) {
+            int64_t stride = rec.addr - p->last_addr;
+            if (stride == p->last_stride) p->same++;
+            // Voto de mayoria para el stride dominante
+            if (p->votes == 0) { p->candidate = stride; p->votes = 1; }
+            else if (stride == p->candidate) p->votes++;
+            else p->votes--;
+            p->last_stride = stride;
+        }
+        p->last_addr = rec.addr;
+        p->count++;
+    }
+    if (r < 0) printf("Warning: trace truncated after %" PRIu64 " records\n", tr->records);
+    if (window_lines.len) {
+        printf("  %12" PRIu64 "  lines %8" PRIu64 "  (%8" PRIu64 " KiB)  pages %6" PRIu64 "  (partial)\n",
+               next_window - window, window_lines.len, (window_lines.len << line_bits) / 1024, window_pages.len);
+        if (window_lines.len > ws_max_lines) ws_max_lines = window_lines.len;
+        if (window_pages.len > ws_max_pages) ws_max_pages = window_pages.len;
+        ws_sum_lines += window_lines.len;
+        windows++;
+    }
+
+    printf("\nInstructions      : %" PRIu64 "\n", tr->records);
+    printf("Memory accesses   : %" PRIu64 " (%" PRIu64 " loads, %" PRIu64 " stores)\n", accesses, loads, stores);
+    printf("Footprint         : %" PRIu64 " lines (%" PRIu64 " KiB), %" PRIu64 " pages\n",
+           last_use.len, (last_use.len << line_bits) / 1024, footprint_pages.len);
+    printf("Working set       : max %" PRIu64 " lines, mean %.1f lines, max %" PRIu64 " pages\n",
+           ws_max_lines, windows ? (double)ws_sum_lines / windows : 0.0, ws_max_pages);
+
+    // Un LRU totalmente asociativo de C lineas acierta todo acceso con distancia < C
+    printf("\nReuse distance (distinct lines between accesses):\n");
+    uint64_t cumulative = 0;
+    for (int b = 0; b < RD_BUCKETS - 1; b++) {
+        if (!hist[b]) continue;
+        cumulative += hist[b];
+        uint64_t lo = b ? 1ULL << (b - 1) : 0, hi = b ? (1ULL << b) - 1 : 0;
+        printf("  %10" PRIu64 "-%-10" PRIu64 " %12" PRIu64 "  cumulative %6.2f%%\n", lo, hi, hist[b],
+               100.0 * cumulative / accesses);
+    }
+    printf("  %-21s %12" PRIu64 "\n", "cold", hist[RD_BUCKETS - 1]);
+
+    uint32_t *idx = malloc(text_slots * sizeof(uint32_t)), n = 0;
+    for (uint32_t i = 0; i < text_slots; i++)
+        if (load_pcs[i].count) idx[n++] = i;
+    qsort(idx, n, sizeof(uint32_t), by_count_desc);
+    printf("\nLoad PCs by count:\n");
+    for (uint32_t k = 0; k < n && k < top; k++) {
+        LoadPC *p = &load_pcs[idx[k]];
+        uint64_t strides = p->count - 1;
+        printf("  0x%08" PRIx64 "  loads %10" PRIu64 "  dominant stride %6" PRId64 "  repeated %6.2f%%\n",
+               tr->header.text_start + 4 * idx[k], p->count, p->candidate,
+               strides ? 100.0 * p->same / strides : 0.0);
+    }
+
+    trace_close(tr);
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "trace_read.h"
+
+// Expande una traza binaria a texto, una instruccion por linea:
+//   pc  encoding  [Xd = valor]  [ld|st tamano [direccion] valor]
+int main(int argc, char *argv[]) {
+    TraceRecord rec;
+    uint64_t limit = UINT64_MAX;
+    int r = 0;
+
+    if (argc < 2) {
+        printf("Usage: %s <trace> [max_records]\n", argv[0]);
+        return 1;
+    }
+    if (argc > 2) limit = strtoull(argv[2], NULL, 0);
+
+    TraceReader *tr = trace_open(argv[1]);
+    if (!tr) {
+        printf("Error: %s is not a trace file\n", argv[1]);
+        return 1;
+    }
+    while (tr->records < limit && (r = trace_next(tr, &rec)) == 1) {
+        printf("0x%08" PRIx64 "  %08x", rec.pc, rec.instr);
+        if (rec.has_dst) {
+            if (rec.dst == 32)
+                printf("  SP = 0x%" PRIx64, rec.dst_value);
+            else
+                printf("  X%d = 0x%" PRIx64, rec.dst, rec.dst_value);
+        }
+        if (rec.has_mem)
+            printf("  %s%d [0x%" PRIx64 "] 0x%" PRIx64, rec.is_store ? "st" : "ld", rec.size, rec.addr, rec.value);
+        printf("\n");
+    }
+    if (r < 0) printf("Warning: trace truncated after %" PRIu64 " records\n", tr->records);
+    trace_close(tr);
+    return 0;
+}